@@ -3,17 +3,23 @@
 #endif
 
 #include "CanvasElement.h"
+#include "SvgPath.h"
+#include "my_log.h"
 #include <variant>
 #include <cmath>
 #include <algorithm>
 #include <limits>
 
 
-std::vector<wxPoint> CanvasElement::CalculateBezier(const Point& p0, const Point& p1, const Point& p2, int segments) const
+namespace {
+
+const int kCurveSegments = 16;
+
+std::vector<Point> TessellateBezier(const Point& p0, const Point& p1, const Point& p2)
 {
-    std::vector<wxPoint> pts;
-    for (int i = 0; i <= segments; ++i) {
-        double t = double(i) / segments;
+    std::vector<Point> pts;
+    for (int i = 0; i <= kCurveSegments; ++i) {
+        double t = double(i) / kCurveSegments;
         double x = (1 - t) * (1 - t) * p0.x + 2 * (1 - t) * t * p1.x + t * t * p2.x;
         double y = (1 - t) * (1 - t) * p0.y + 2 * (1 - t) * t * p1.y + t * t * p2.y;
         pts.emplace_back(static_cast<int>(x), static_cast<int>(y));
@@ -21,33 +27,116 @@ std::vector<wxPoint> CanvasElement::CalculateBezier(const Point& p0, const Point
     return pts;
 }
 
-CanvasElement::CanvasElement(const wxString& name, const wxPoint& pos)
-    : m_name(name), m_pos(pos)
+std::vector<Point> TessellateArc(const ArcShape& arc)
 {
+    std::vector<Point> pts;
+    double startRad = arc.startAngle * M_PI / 180.0;
+    double endRad = arc.endAngle * M_PI / 180.0;
+    for (int i = 0; i <= kCurveSegments; ++i) {
+        double t = double(i) / kCurveSegments;
+        double angle = startRad + t * (endRad - startRad);
+        pts.emplace_back(arc.center.x + static_cast<int>(arc.radius * cos(angle)),
+            arc.center.y + static_cast<int>(arc.radius * sin(angle)));
+    }
+    return pts;
 }
 
-void CanvasElement::Draw(wxDC& dc) const
+// 局部坐标按朝向顺时针旋转（屏幕坐标系 y 向下）
+Point Rotate(const Point& p, Facing f)
 {
-    auto off = [&](const Point& p) {
-        return wxPoint(m_pos.x + p.x, m_pos.y + p.y);
-        };
+    switch (f) {
+    case Facing::South: return Point(-p.y, p.x);
+    case Facing::West:  return Point(-p.x, -p.y);
+    case Facing::North: return Point(p.y, -p.x);
+    default:            return p;
+    }
+}
+
+} // namespace
+
+Facing FacingFromString(const wxString& s)
+{
+    if (s.IsSameAs("South", false)) return Facing::South;
+    if (s.IsSameAs("West", false))  return Facing::West;
+    if (s.IsSameAs("North", false)) return Facing::North;
+    return Facing::East;
+}
 
+wxString FacingToString(Facing f)
+{
+    switch (f) {
+    case Facing::South: return "South";
+    case Facing::West:  return "West";
+    case Facing::North: return "North";
+    default:            return "East";
+    }
+}
+
+CanvasElement::CanvasElement(std::shared_ptr<const ElementPrototype> proto, const wxPoint& pos, Facing facing)
+    : m_proto(std::move(proto)), m_pos(pos), m_facing(facing)
+{
+    UpdateWorldCache();
+}
+
+wxPoint CanvasElement::ToWorld(const Point& p) const
+{
+    Point r = Rotate(p, m_facing);
+    return wxPoint(m_pos.x + r.x, m_pos.y + r.y);
+}
+
+wxString CanvasElement::GetProperty(const wxString& name, const wxString& def) const
+{
+    auto it = m_props.find(name);
+    return it != m_props.end() ? it->second : def;
+}
 
-    for (const auto& shape : m_shapes)
+void CanvasElement::Draw(wxDC& dc, DetailLevel detail) const
+{
+    if (detail == DetailLevel::Box) {
+        const wxColour c(160, 160, 160);
+        dc.SetPen(wxPen(c, 1));
+        dc.SetBrush(wxBrush(c));
+        dc.DrawRectangle(GetBounds());
+        return;
+    }
+
+    auto off = [&](const Point& p) { return ToWorld(p); };
+    // 画刷在本地构造：后台光栅化线程也调用 Draw，复制全局库存对象的引用计数不是线程安全的
+    const wxBrush noFill(wxColour(0, 0, 0), wxBRUSHSTYLE_TRANSPARENT);
+    const ElementPrototype& proto = *m_proto;
+    std::vector<wxPoint> buf;   // 折线变换到世界坐标的缓冲，各图形共用
+
+    // 画第 shapeIdx 个图形预先细分好的折线
+    auto drawPolylines = [&](size_t shapeIdx, bool asPolygon) {
+        for (uint32_t k = proto.shapeLines[shapeIdx]; k < proto.shapeLines[shapeIdx + 1]; ++k) {
+            const auto& line = proto.tessLines[k];
+            buf.clear();
+            for (uint32_t j = 0; j < line.count; ++j)
+                buf.push_back(off(proto.tessPoints[line.first + j]));
+            if (buf.size() < 2) continue;
+            if (asPolygon && line.closed)
+                dc.DrawPolygon(static_cast<int>(buf.size()), buf.data());
+            else
+                dc.DrawLines(static_cast<int>(buf.size()), buf.data());
+        }
+        };
+
+    for (size_t shapeIdx = 0; shapeIdx < proto.shapes.size(); ++shapeIdx)
     {
+        const auto& shape = proto.shapes[shapeIdx];
 
         auto visitor = [&](const auto& arg) {
             using T = std::decay_t<decltype(arg)>;
 
             if constexpr (std::is_same_v<T, PolyShape>) {
-                std::vector<wxPoint> pts;
+                buf.clear();
                 for (const auto& p : arg.pts) {
-                    pts.push_back(off(p));
+                    buf.push_back(off(p));
                 }
-                dc.SetBrush(*wxTRANSPARENT_BRUSH);
+                dc.SetBrush(noFill);
                 dc.SetPen(wxPen(arg.color, 2));
-                if (!pts.empty()) {
-                    dc.DrawPolygon(static_cast<int>(pts.size()), pts.data());
+                if (!buf.empty()) {
+                    dc.DrawPolygon(static_cast<int>(buf.size()), buf.data());
                 }
             }
             else if constexpr (std::is_same_v<T, Line>) {
@@ -61,177 +150,163 @@ void CanvasElement::Draw(wxDC& dc) const
                     dc.SetBrush(wxBrush(arg.fillColor));  // 设置填充画刷
                 }
                 else {
-                    dc.SetBrush(*wxTRANSPARENT_BRUSH);
+                    dc.SetBrush(noFill);
                 }
 
                 dc.SetPen(wxPen(arg.color, 2));
                 dc.DrawCircle(off(arg.center), arg.radius);
             }
             else if constexpr (std::is_same_v<T, Text>) {
+                if (detail != DetailLevel::Full) return;
                 dc.SetTextForeground(arg.color);
                 dc.SetFont(wxFont(arg.fontSize, wxFONTFAMILY_DEFAULT,
                     wxFONTSTYLE_NORMAL, wxFONTWEIGHT_NORMAL));
                 dc.DrawText(arg.text, off(arg.pos));
             }
             else if constexpr (std::is_same_v<T, ArcShape>) {
-                dc.SetBrush(*wxTRANSPARENT_BRUSH);
+                dc.SetBrush(noFill);
                 dc.SetPen(wxPen(arg.color, 2));
-
-                double startRad = arg.startAngle * M_PI / 180.0;
-                double endRad = arg.endAngle * M_PI / 180.0;
-
-                std::vector<wxPoint> arcPoints;
-                int segments = 16;
-                for (int i = 0; i <= segments; ++i) {
-                    double t = double(i) / segments;
-                    double angle = startRad + t * (endRad - startRad);
-                    int x = arg.center.x + static_cast<int>(arg.radius * cos(angle));
-                    int y = arg.center.y + static_cast<int>(arg.radius * sin(angle));
-                    arcPoints.push_back(off(Point(x, y)));
-                }
-
-                if (arcPoints.size() >= 2) {
-                    dc.DrawLines(static_cast<int>(arcPoints.size()), arcPoints.data());
-                }
+                drawPolylines(shapeIdx, false);
             }
             else if constexpr (std::is_same_v<T, BezierShape>) {
                 dc.SetPen(wxPen(arg.color, 2));
-                auto bezierPoints = CalculateBezier(arg.p0, arg.p1, arg.p2);
-
-                std::vector<wxPoint> screenPoints;
-                for (const auto& wp : bezierPoints) {
-                    // �� wxPoint ת��Ϊ Point��Ȼ���ٵ��� off
-                    Point p{ wp.x, wp.y };
-                    screenPoints.push_back(off(p));
-                }
-
-                if (!screenPoints.empty()) {
-                    dc.DrawLines(static_cast<int>(screenPoints.size()), screenPoints.data());
-                }
+                drawPolylines(shapeIdx, false);
             }
             else if constexpr (std::is_same_v<T, Path>) {
                 dc.SetPen(wxPen(arg.stroke, arg.strokeWidth));
-                dc.SetBrush(arg.fill ? wxBrush(arg.stroke) : *wxTRANSPARENT_BRUSH);
-
-                std::string d = arg.d;
-                if (d.find("A 16 28") != std::string::npos) {
-
-                    int verticalLineLength = 40;
-                    int radius = verticalLineLength / 2;
-
-                    dc.DrawLine(off(Point(10, 12)), off(Point(10, 52)));
-
-                    dc.DrawLine(off(Point(10, 12)), off(Point(10 + radius, 12)));
-
-                    dc.DrawLine(off(Point(10, 52)), off(Point(10 + radius, 52)));
-
-
-                    std::vector<wxPoint> arcPoints;
-                    for (int angle = -90; angle <= 90; angle += 5) {
-                        double rad = angle * M_PI / 180.0;
-                        int x = 30 + static_cast<int>(radius * cos(rad));
-                        int y = 32 + static_cast<int>(radius * sin(rad));
-                        arcPoints.push_back(off(Point(x, y)));
-                    }
-
-
-                    if (arcPoints.size() >= 2) {
-                        for (size_t i = 1; i < arcPoints.size(); i++) {
-                            dc.DrawLine(arcPoints[i - 1], arcPoints[i]);
-                        }
-                    }
-                }
+                dc.SetBrush(arg.fill ? wxBrush(arg.stroke) : noFill);
+                drawPolylines(shapeIdx, true);
             }
             };
 
         std::visit(visitor, shape);
     }
 
+    if (detail != DetailLevel::Full) return;
+
     // 绘制输入引脚（左边，蓝色）
-    for (const auto& pin : m_inputPins) {
-        wxPoint p = off(pin.pos);
+    for (const auto& pin : m_proto->inputPins) {
         dc.SetPen(wxPen(wxColour(0, 0, 255), 2)); // 蓝色 (RGB: 0,0,255)
-        dc.DrawLine(p, wxPoint(p.x - 6, p.y));
+        dc.DrawLine(off(pin.pos), off(Point(pin.pos.x - 6, pin.pos.y)));
     }
 
     // 绘制输出引脚（右边，红色）
-    for (const auto& pin : m_outputPins) {
-        wxPoint p = off(pin.pos);
+    for (const auto& pin : m_proto->outputPins) {
         dc.SetPen(wxPen(wxColour(255, 0, 0), 2)); // 红色 (RGB: 255,0,0)
-        dc.DrawLine(p, wxPoint(p.x + 6, p.y));
+        dc.DrawLine(off(pin.pos), off(Point(pin.pos.x + 6, pin.pos.y)));
     }
 }
 
-wxRect CanvasElement::GetBounds() const
+//================= 原型构建 =================
+void ElementPrototype::AddShape(const Shape& shape)
 {
-    if (m_shapes.empty()) return wxRect(m_pos, wxSize(1, 1));
-
-    int minX = std::numeric_limits<int>::max();
-    int minY = std::numeric_limits<int>::max();
-    int maxX = std::numeric_limits<int>::min();
-    int maxY = std::numeric_limits<int>::min();
-
-    auto update = [&](const Point& p) {
-        int x = m_pos.x + p.x;
-        int y = m_pos.y + p.y;
-        minX = std::min(minX, x);
-        minY = std::min(minY, y);
-        maxX = std::max(maxX, x);
-        maxY = std::max(maxY, y);
+    shapes.push_back(shape);
+
+    auto visitor = [&](const auto& arg) {
+        using T = std::decay_t<decltype(arg)>;
+
+        if constexpr (std::is_same_v<T, PolyShape>) {
+            for (const auto& pt : arg.pts) Extend(pt);
+        }
+        else if constexpr (std::is_same_v<T, Line>) {
+            Extend(arg.start);
+            Extend(arg.end);
+        }
+        else if constexpr (std::is_same_v<T, Circle>) {
+            Extend(Point(arg.center.x - arg.radius, arg.center.y - arg.radius));
+            Extend(Point(arg.center.x + arg.radius, arg.center.y + arg.radius));
+        }
+        else if constexpr (std::is_same_v<T, Text>) {
+            Extend(arg.pos);
+            Extend(Point(arg.pos.x + 20, arg.pos.y + 10));
+        }
+        else if constexpr (std::is_same_v<T, ArcShape>) {
+            AddPolyline(TessellateArc(arg), false);
+        }
+        else if constexpr (std::is_same_v<T, BezierShape>) {
+            AddPolyline(TessellateBezier(arg.p0, arg.p1, arg.p2), false);
+        }
+        else if constexpr (std::is_same_v<T, Path>) {
+            std::vector<SvgSubpath> subpaths;
+            if (!TessellateSvgPath(arg.d, subpaths, kCurveSegments))
+                MyLog("ElementPrototype: bad path data in <%s>\n", name.ToUTF8().data());
+            for (const auto& sub : subpaths) {
+                std::vector<Point> pts;
+                pts.reserve(sub.pts.size());
+                for (const auto& p : sub.pts)
+                    pts.emplace_back(static_cast<int>(std::lround(p.x)), static_cast<int>(std::lround(p.y)));
+                AddPolyline(pts, sub.closed);
+            }
+        }
         };
+    std::visit(visitor, shape);
+    shapeLines.push_back(static_cast<uint32_t>(tessLines.size()));
+}
 
-    for (const auto& shape : m_shapes) {
-        auto visitor = [&](const auto& arg) {
-            using T = std::decay_t<decltype(arg)>;
+void ElementPrototype::AddPolyline(const std::vector<Point>& pts, bool closed)
+{
+    Polyline line;
+    line.first = static_cast<uint32_t>(tessPoints.size());
+    line.count = static_cast<uint32_t>(pts.size());
+    line.closed = closed;
+    tessLines.push_back(line);
+    for (const auto& p : pts) {
+        tessPoints.push_back(p);
+        Extend(p);
+    }
+}
 
-            if constexpr (std::is_same_v<T, PolyShape>) {
-                for (const auto& pt : arg.pts) update(pt);
-            }
-            else if constexpr (std::is_same_v<T, Line>) {
-                update(arg.start);
-                update(arg.end);
-            }
-            else if constexpr (std::is_same_v<T, Circle>) {
-                update(Point(arg.center.x - arg.radius, arg.center.y - arg.radius));
-                update(Point(arg.center.x + arg.radius, arg.center.y + arg.radius));
-            }
-            else if constexpr (std::is_same_v<T, Text>) {
-                update(arg.pos);
-                update(Point(arg.pos.x + 20, arg.pos.y + 10));
-            }
-            else if constexpr (std::is_same_v<T, ArcShape>) {
-                update(Point(arg.center.x - arg.radius, arg.center.y - arg.radius));
-                update(Point(arg.center.x + arg.radius, arg.center.y + arg.radius));
-            }
-            else if constexpr (std::is_same_v<T, BezierShape>) {
-                auto pts = CalculateBezier(arg.p0, arg.p1, arg.p2);
-                for (const auto& wp : pts) {
+void ElementPrototype::AddInputPin(const Point& p, const wxString& pinName)
+{
+    inputPins.push_back(Pin(p, pinName, true));
+    Extend(p);
+    Extend(Point(p.x - 6, p.y));
+}
 
-                    Point p{ wp.x, wp.y };
-                    update(p);
-                }
-            }
-            else if constexpr (std::is_same_v<T, Path>) {
-                if (arg.d.find("A 16 28") != std::string::npos) {
-                    update(Point(10, 12));
-                    update(Point(50, 52));
-                }
-            }
-            };
+void ElementPrototype::AddOutputPin(const Point& p, const wxString& pinName)
+{
+    outputPins.push_back(Pin(p, pinName, false));
+    Extend(p);
+    Extend(Point(p.x + 6, p.y));
+}
 
-        std::visit(visitor, shape);
-    }
+void ElementPrototype::Extend(const Point& p)
+{
+    minX = std::min(minX, p.x);
+    minY = std::min(minY, p.y);
+    maxX = std::max(maxX, p.x);
+    maxY = std::max(maxY, p.y);
+}
 
+//================= 实例缓存 =================
+void CanvasElement::SetPos(const wxPoint& p)
+{
+    m_pos = p;
+    UpdateWorldCache();
+}
 
-    for (const auto& pin : m_inputPins) {
-        update(pin.pos);
-        update(Point(pin.pos.x - 6, pin.pos.y));
-    }
+void CanvasElement::SetFacing(Facing f)
+{
+    m_facing = f;
+    UpdateWorldCache();
+}
 
-    for (const auto& pin : m_outputPins) {
-        update(pin.pos);
-        update(Point(pin.pos.x + 6, pin.pos.y));
+void CanvasElement::UpdateWorldCache()
+{
+    const auto& in = m_proto->inputPins;
+    const auto& out = m_proto->outputPins;
+    m_inputWorld.resize(in.size());
+    for (size_t i = 0; i < in.size(); ++i) m_inputWorld[i] = ToWorld(in[i].pos);
+    m_outputWorld.resize(out.size());
+    for (size_t i = 0; i < out.size(); ++i) m_outputWorld[i] = ToWorld(out[i].pos);
+
+    // 没有图形的元件只占一个像素（引脚不单独撑开包围盒）
+    if (m_proto->shapes.empty()) {
+        m_bounds = wxRect(m_pos, wxSize(1, 1));
+        return;
     }
-
-    return wxRect(minX, minY, maxX - minX + 1, maxY - minY + 1);
-}
\ No newline at end of file
+    wxPoint a = ToWorld(Point(m_proto->minX, m_proto->minY));
+    wxPoint b = ToWorld(Point(m_proto->maxX, m_proto->maxY));
+    m_bounds = wxRect(std::min(a.x, b.x), std::min(a.y, b.y),
+        std::abs(b.x - a.x) + 1, std::abs(b.y - a.y) + 1);
+}
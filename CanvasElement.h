@@ -2,6 +2,10 @@
 #include <wx/wx.h>
 #include <vector>
 #include <variant>
+#include <limits>
+#include <map>
+#include <memory>
+#include <cstdint>
 
 struct Point {
     int x, y;
@@ -90,30 +94,89 @@ struct Path {
 // ʹ
 using Shape = std::variant<Line, PolyShape, Circle, Text, Path, ArcShape, BezierShape>;
 
+// Ԫ canvas_elements.json еͼΣ˳ʱת 0/90/180/270 
+enum class Facing : uint8_t { East, South, West, North };
+Facing   FacingFromString(const wxString& s);   // "East"/"South"/"West"/"North"Сд
+wxString FacingToString(Facing f);
+
+// ϸڲΣúСʱʡԿĲ
+// Full ȫOutline ֻͼΣʡֺţBox ֻİΧ
+enum class DetailLevel : uint8_t { Full, Outline, Box };
+
+// Ԫţ canvas_elements.json ʱ˳䣬ԭԪе±
+using ComponentId = uint16_t;
+constexpr ComponentId kInvalidComponent = 0xFFFF;
+
+// ԪԭͣͼκŶ壬ʱһΣֻ֮ͬʵԪ
+struct ElementPrototype
+{
+    ComponentId id = kInvalidComponent;
+    wxString name;
+    std::vector<Shape> shapes;
+    std::vector<Pin> inputPins;
+    std::vector<Pin> outputPins;
+
+    // Բ path  AddShape ʱϸֺõߣֲ꣩ƺͰΧֱʹ
+    struct Polyline { uint32_t first = 0, count = 0; bool closed = false; };
+    std::vector<Point>    tessPoints;
+    std::vector<Polyline> tessLines;
+    std::vector<uint32_t> shapeLines{ 0 };   // shapes[i] Ϊ tessLines[shapeLines[i], shapeLines[i+1])
+
+    // ֲΧУԪԭ㡢ͼ/ʱۼ
+    int minX = std::numeric_limits<int>::max();
+    int minY = std::numeric_limits<int>::max();
+    int maxX = std::numeric_limits<int>::min();
+    int maxY = std::numeric_limits<int>::min();
+
+    void AddShape(const Shape& shape);
+    void AddInputPin(const Point& p, const wxString& pinName);
+    void AddOutputPin(const Point& p, const wxString& pinName);
+
+private:
+    void Extend(const Point& p);
+    void AddPolyline(const std::vector<Point>& pts, bool closed);
+};
+
 class CanvasElement
 {
 public:
-    CanvasElement(const wxString& name, const wxPoint& pos);
-    void Draw(wxDC& dc) const;
-    void AddShape(const Shape& shape) { m_shapes.push_back(shape); }
-    void AddInputPin(const Point& p, const wxString& name) { m_inputPins.push_back(Pin(p, name, true)); }
-    void AddOutputPin(const Point& p, const wxString& name) { m_outputPins.push_back(Pin(p, name, false)); }
-    void SetPos(const wxPoint& p) { m_pos = p; }
-
-    const wxString& GetName() const { return m_name; }
+    CanvasElement(std::shared_ptr<const ElementPrototype> proto, const wxPoint& pos, Facing facing = Facing::East);
+    void Draw(wxDC& dc, DetailLevel detail = DetailLevel::Full) const;
+    void SetPos(const wxPoint& p);
+    void SetFacing(Facing f);
+
+    ComponentId GetComponentId() const { return m_proto->id; }
+    const wxString& GetName() const { return m_proto->name; }
     const wxPoint& GetPos() const { return m_pos; }
-    const std::vector<Shape>& GetShapes() const { return m_shapes; }
-    const std::vector<Pin>& GetInputPins() const { return m_inputPins; }
-    const std::vector<Pin>& GetOutputPins() const { return m_outputPins; }
+    Facing GetFacing() const { return m_facing; }
+    const std::vector<Shape>& GetShapes() const { return m_proto->shapes; }
+    const std::vector<Pin>& GetInputPins() const { return m_proto->inputPins; }
+    const std::vector<Pin>& GetOutputPins() const { return m_proto->outputPins; }
+    const std::shared_ptr<const ElementPrototype>& GetPrototype() const { return m_proto; }
+
+    // ʵԣLabel ȣֻԭĬֵͬ
+    void SetProperty(const wxString& name, const wxString& value) { m_props[name] = value; }
+    wxString GetProperty(const wxString& name, const wxString& def = wxEmptyString) const;
+    const std::map<wxString, wxString>& GetProperties() const { return m_props; }
 
-    wxRect GetBounds() const;
+    // ꣨ת GetPos() SetPos/SetFacing 
+    const std::vector<wxPoint>& GetInputPinWorld() const { return m_inputWorld; }
+    const std::vector<wxPoint>& GetOutputPinWorld() const { return m_outputWorld; }
+
+    // ΧУԭ͵ľֲΧб任õ
+    const wxRect& GetBounds() const { return m_bounds; }
 
 private:
-    wxString m_name;
+    std::shared_ptr<const ElementPrototype> m_proto;
     wxPoint m_pos;
-    std::vector<Shape> m_shapes;
-    std::vector<Pin> m_inputPins;
-    std::vector<Pin> m_outputPins;
+    Facing m_facing = Facing::East;
+    std::map<wxString, wxString> m_props;
+
+    // 棺Χλ
+    wxRect m_bounds;
+    std::vector<wxPoint> m_inputWorld;
+    std::vector<wxPoint> m_outputWorld;
 
-    std::vector<wxPoint> CalculateBezier(const Point& p0, const Point& p1, const Point& p2, int segments = 16) const;
-};
\ No newline at end of file
+    wxPoint ToWorld(const Point& p) const;   // ֲ  ת  ƽ
+    void UpdateWorldCache();
+};
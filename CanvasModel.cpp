@@ -3,11 +3,21 @@
 #include <wx/filename.h>
 #include <wx/stdpaths.h>
 #include <fstream>
+#include <unordered_map>
 #include <json/json.h>
 #include "my_log.h"
 
 std::vector<CanvasElement> g_elements;
 
+// 元件名称驻留表：名称只在加载和打开文件时哈希一次，实例只保存编号
+static std::unordered_map<wxString, ComponentId, wxStringHash, wxStringEqual> g_componentIds;
+
+ComponentId FindComponentId(const wxString& name)
+{
+    auto it = g_componentIds.find(name);
+    return it != g_componentIds.end() ? it->second : kInvalidComponent;
+}
+
 std::vector<CanvasElement> LoadCanvasElements(const wxString& jsonPath)
 {
     /*std::ifstream f(jsonPath.ToStdString(), std::ios::binary);
@@ -40,11 +50,18 @@ std::vector<CanvasElement> LoadCanvasElements(const wxString& jsonPath)
     if (!Json::parseFromStream(builder, f, &root, &errs)) return {};
 
     std::vector<CanvasElement> out;
+    g_componentIds.clear();
     for (const auto& elem : root) {
         wxString id = wxString::FromUTF8(elem["id"].asString());
         wxString name = wxString::FromUTF8(elem["name"].asString());
         wxPoint  pos(elem["anchorPoint"][0].asInt(), elem["anchorPoint"][1].asInt());
-        CanvasElement ce(name, pos);
+        if (out.size() >= kInvalidComponent) {
+            MyLog("LoadCanvas: too many components, rest ignored\n");
+            break;
+        }
+        ElementPrototype ce;
+        ce.id = static_cast<ComponentId>(out.size());
+        ce.name = name;
 
         // ������
         for (const auto& pin : elem["inputPins"])
@@ -132,7 +149,10 @@ std::vector<CanvasElement> LoadCanvasElements(const wxString& jsonPath)
             }
 
         }
-        out.push_back(ce);
+        // 重名时保留第一个，与原来的线性查找一致
+        g_componentIds.emplace(name, ce.id);
+        // 同名元件的所有实例共享这一份只读原型
+        out.emplace_back(std::make_shared<const ElementPrototype>(std::move(ce)), pos);
     }
     return out;
 }
\ No newline at end of file
@@ -3,8 +3,15 @@
 #include <vector>
 #include <json/json.h>   
 
+#include <cstdint>
+
 // ǰѭ
 class CanvasElement;
+using ComponentId = uint16_t;
+
+// ȫֺ JSON  Ԫбͬʱ  ŵפ
+// б±Ԫ
+std::vector<CanvasElement> LoadCanvasElements(const wxString& jsonPath);
 
-// ȫֺ JSON  Ԫб
-std::vector<CanvasElement> LoadCanvasElements(const wxString& jsonPath);
\ No newline at end of file
+// ƲԪţϣO(1)Ҳ kInvalidComponent
+ComponentId FindComponentId(const wxString& name);
\ No newline at end of file
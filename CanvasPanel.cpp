@@ -3,6 +3,7 @@
 #include "Wire.h"
 #include <wx/dcbuffer.h>
 #include "CanvasElement.h"
+#include "CanvasModel.h"
 #include "my_log.h"
 
 wxBEGIN_EVENT_TABLE(CanvasPanel, wxPanel)
@@ -12,17 +13,19 @@ EVT_LEFT_UP(CanvasPanel::OnLeftUp)
 EVT_MOTION(CanvasPanel::OnMouseMove)
 EVT_KEY_DOWN(CanvasPanel::OnKeyDown)
 EVT_MOUSEWHEEL(CanvasPanel::OnMouseWheel)
+EVT_TIMER(CanvasPanel::ID_REROUTE_TIMER, CanvasPanel::OnRerouteTimer)
 wxEND_EVENT_TABLE()
 
 CanvasPanel::CanvasPanel(wxWindow* parent)
     : wxPanel(parent, wxID_ANY, wxDefaultPosition, wxDefaultSize,
         wxFULL_REPAINT_ON_RESIZE | wxBORDER_NONE),
     m_offset(0, 0), m_isPanning(false), m_scale(1.0f),
-    m_wireMode(WireMode::Idle), m_selectedIndex(-1), m_isDragging(false),
-    m_hoverPinIdx(-1), m_hoverCellIdx(-1), m_hoverCellWire(-1) {
+    m_wireMode(WireMode::Idle), m_isDragging(false),
+    m_hoverPinIdx(-1), m_hoverSegWire(-1), m_hoverSegIdx(-1) {
 
     SetBackgroundStyle(wxBG_STYLE_PAINT);
     SetBackgroundColour(*wxWHITE);
+    m_rerouteTimer.SetOwner(this, ID_REROUTE_TIMER);
     MyLog("CanvasPanel: constructed\n");
 }
 
@@ -84,24 +87,27 @@ void CanvasPanel::OnKeyDown(wxKeyEvent& evt) {
     }
 
     // 原有的删除元件逻辑
-    if (evt.GetKeyCode() == WXK_DELETE && m_selectedIndex != -1) {
+    const int selected = GetSelectedIndex();
+    if (evt.GetKeyCode() == WXK_DELETE && selected != -1) {
         // 删除元件前先更新连接的导线
         for (const auto& aw : m_movingWires) {
-            if (aw.wireIdx >= m_wires.size()) continue;
-            Wire& wire = m_wires[aw.wireIdx];
-            const auto& elem = m_elements[m_selectedIndex];
-            const auto& pins = aw.isInput ? elem.GetInputPins() : elem.GetOutputPins();
+            int wireIdx = m_wires.IndexOf(aw.wire);
+            if (wireIdx < 0) continue;
+            Wire& wire = m_wires[wireIdx];
+            const auto& elem = m_elements[selected];
+            const auto& pins = aw.isInput ? elem.GetInputPinWorld() : elem.GetOutputPinWorld();
             if (aw.pinIdx >= pins.size()) continue;
 
-            wxPoint newPin = elem.GetPos() + wxPoint(pins[aw.pinIdx].pos.x, pins[aw.pinIdx].pos.y);
+            wxPoint newPin = pins[aw.pinIdx];
             if (aw.ptIdx == 0)
                 wire.pts.front().pos = newPin;
             else
                 wire.pts.back().pos = newPin;
+            UpdateWire(wireIdx);
         }
 
-        m_elements.erase(m_elements.begin() + m_selectedIndex);
-        m_selectedIndex = -1;
+        EraseElement(selected);
+        m_selected = ElementHandle();
         Refresh();
     }
     else {
@@ -125,13 +131,8 @@ void CanvasPanel::OnMouseWheel(wxMouseEvent& evt) {
 
 bool CanvasPanel::IsClickOnEmptyArea(const wxPoint& canvasPos)
 {
-    // 遍历所有元素，判断点击位置是否在任何元素内部
-    for (const auto& elem : m_elements) {
-        if (elem.GetBounds().Contains(canvasPos)) {
-            return false; // 点击在元素上，不是空白区域
-        }
-    }
-    return true; // 空白区域
+    // 只检查点击位置所在格子里的元素
+    return m_elementIndex.HitTest(canvasPos) == -1;
 }  
 
 // 新增：设置缩放比例（限制范围0.1~5.0，避免过度缩放）
@@ -148,6 +149,20 @@ void CanvasPanel::SetScale(float scale)
     }
 }
 
+void CanvasPanel::SetDetailThresholds(float outlineBelow, float boxBelow)
+{
+    m_lodOutlineBelow = outlineBelow;
+    m_lodBoxBelow = std::min(boxBelow, outlineBelow);
+    RefreshScene();
+}
+
+DetailLevel CanvasPanel::GetDetailLevel() const
+{
+    if (m_scale < m_lodBoxBelow) return DetailLevel::Box;
+    if (m_scale < m_lodOutlineBelow) return DetailLevel::Outline;
+    return DetailLevel::Full;
+}
+
 
 // 新增：屏幕坐标转画布坐标（除以缩放因子）
 wxPoint CanvasPanel::ScreenToCanvas(const wxPoint& screenPos) const
@@ -158,6 +173,161 @@ wxPoint CanvasPanel::ScreenToCanvas(const wxPoint& screenPos) const
     );
 }
 
+// 当前可见区域（画布坐标），向外留出线宽和引脚短线的余量
+wxRect CanvasPanel::GetViewRect() const
+{
+    wxSize sz = GetClientSize();
+    wxPoint tl = ScreenToCanvas(wxPoint(0, 0));
+    wxPoint br = ScreenToCanvas(wxPoint(sz.x, sz.y));
+    return wxRect(tl, br).Inflate(4);
+}
+
+void CanvasPanel::RefreshCanvasRect(const wxRect& canvasRect)
+{
+    if (canvasRect.width <= 0 || canvasRect.height <= 0) return;
+    wxRect r = canvasRect;
+    r.Inflate(3);   // 线宽 2、抗锯齿边缘
+    wxPoint tl = CanvasToScreen(r.GetTopLeft());
+    wxPoint br = CanvasToScreen(wxPoint(r.GetRight() + 1, r.GetBottom() + 1));
+    RefreshRect(wxRect(tl, br).Inflate(1), false);
+}
+
+void CanvasPanel::RefreshWire(size_t wireIdx)
+{
+    if (wireIdx < m_wires.size()) RefreshCanvasRect(m_wires[wireIdx].GetBounds());
+}
+
+void CanvasPanel::RefreshElement(size_t elemIdx)
+{
+    if (elemIdx < m_elements.size()) RefreshCanvasRect(m_elements[elemIdx].GetBounds());
+}
+
+void CanvasPanel::RefreshScene()
+{
+    ++m_sceneVersion;
+    m_tiles.clear();
+    m_tilePixels = 0;
+    Refresh();
+}
+
+// 只让值变化过的导线所在的图块失效；仿真器给不出（重建过、变化太多）时丢弃全部图块。
+// 形状没变，后台快照只换颜色
+void CanvasPanel::RefreshSimWires()
+{
+    ++m_colourVersion;
+    if (!m_simulator || !m_simulator->GetChangedWires(m_simWires)) {
+        m_tiles.clear();
+        m_tilePixels = 0;
+        Refresh();
+        return;
+    }
+    for (size_t w : m_simWires) {
+        if (w >= m_wires.size()) continue;
+        DropTiles(m_wires[w].GetBounds());
+        RefreshWire(w);
+    }
+}
+
+void CanvasPanel::SetSelected(ElementHandle h)
+{
+    if (h == m_selected) return;
+    // 后台快照不必重建：快照生成时选中的元件由叠加层补画
+    int old = GetSelectedIndex();
+    if (old != -1) DropTiles(m_elements[old].GetBounds());
+    m_selected = h;
+    int cur = GetSelectedIndex();
+    if (cur != -1) DropTiles(m_elements[cur].GetBounds());
+}
+
+//================= 静态内容图块 =================
+namespace {
+int FloorDiv(int a, int b) { return a >= 0 ? a / b : -((-a + b - 1) / b); }
+uint64_t TileKey(int tx, int ty)
+{
+    return (static_cast<uint64_t>(static_cast<uint32_t>(tx)) << 32) | static_cast<uint32_t>(ty);
+}
+}
+
+void CanvasPanel::InvalidateTiles(const wxRect& canvasRect)
+{
+    if (canvasRect.width <= 0 || canvasRect.height <= 0) return;
+    ++m_sceneVersion;
+    DropTiles(canvasRect);
+}
+
+void CanvasPanel::DropTiles(const wxRect& canvasRect)
+{
+    if (canvasRect.width <= 0 || canvasRect.height <= 0 || m_tiles.empty()) return;
+    // 线宽、选中框，加上图块边缘取整造成的一个像素
+    wxRect r = canvasRect;
+    r.Inflate(4 + static_cast<int>(std::ceil(1.0 / m_scale)));
+    const int x0 = FloorDiv(r.GetLeft(), kTileSize), x1 = FloorDiv(r.GetRight(), kTileSize);
+    const int y0 = FloorDiv(r.GetTop(), kTileSize), y1 = FloorDiv(r.GetBottom(), kTileSize);
+
+    auto drop = [this](std::unordered_map<uint64_t, SceneTile>::iterator it) {
+        m_tilePixels -= static_cast<size_t>(it->second.bitmap.GetWidth()) * it->second.bitmap.GetHeight();
+        return m_tiles.erase(it);
+        };
+    if (int64_t(x1 - x0 + 1) * (y1 - y0 + 1) > static_cast<int64_t>(m_tiles.size())) {
+        for (auto it = m_tiles.begin(); it != m_tiles.end();) {
+            const int tx = static_cast<int32_t>(it->first >> 32), ty = static_cast<int32_t>(it->first & 0xFFFFFFFFu);
+            if (tx >= x0 && tx <= x1 && ty >= y0 && ty <= y1) it = drop(it);
+            else ++it;
+        }
+        return;
+    }
+    for (int tx = x0; tx <= x1; ++tx)
+        for (int ty = y0; ty <= y1; ++ty) {
+            auto it = m_tiles.find(TileKey(tx, ty));
+            if (it != m_tiles.end()) drop(it);
+        }
+}
+
+// 图块边缘按 floor 取整，相邻图块严丝合缝
+wxRect CanvasPanel::TilePixelRect(int tx, int ty) const
+{
+    const double t = kTileSize * m_scale;
+    const int x0 = static_cast<int>(std::floor(tx * t)), x1 = static_cast<int>(std::floor((tx + 1) * t));
+    const int y0 = static_cast<int>(std::floor(ty * t)), y1 = static_cast<int>(std::floor((ty + 1) * t));
+    return wxRect(x0, y0, x1 - x0, y1 - y0);
+}
+
+const wxBitmap& CanvasPanel::GetTile(int tx, int ty)
+{
+    const uint64_t key = TileKey(tx, ty);
+    auto it = m_tiles.find(key);
+    if (it != m_tiles.end()) {
+        it->second.lastUse = ++m_tileClock;
+        return it->second.bitmap;
+    }
+
+    const wxRect r = TilePixelRect(tx, ty);
+    const size_t px = static_cast<size_t>(r.width) * r.height;
+    if (m_tilePixels + px > kTileBudget) {
+        // 超出预算：一次丢弃最久未用的约四分之一，避免每块都排序
+        std::vector<std::pair<uint64_t, uint64_t>> byAge;   // (lastUse, key)
+        byAge.reserve(m_tiles.size());
+        for (const auto& kv : m_tiles) byAge.push_back({ kv.second.lastUse, kv.first });
+        std::sort(byAge.begin(), byAge.end());
+        for (const auto& e : byAge) {
+            if (m_tilePixels + px <= kTileBudget / 4 * 3) break;
+            auto old = m_tiles.find(e.second);
+            m_tilePixels -= static_cast<size_t>(old->second.bitmap.GetWidth()) * old->second.bitmap.GetHeight();
+            m_tiles.erase(old);
+        }
+    }
+
+    SceneTile& tile = m_tiles[key];
+    tile.bitmap = wxBitmap(r.width, r.height);
+    tile.lastUse = ++m_tileClock;
+    m_tilePixels += px;
+    {
+        wxMemoryDC mdc(tile.bitmap);
+        DrawStatic(mdc, wxRect(0, 0, r.width, r.height), wxPoint(-r.x, -r.y));
+    }
+    return tile.bitmap;
+}
+
 // 新增：画布坐标转屏幕坐标（乘以缩放因子）
 wxPoint CanvasPanel::CanvasToScreen(const wxPoint& canvasPos) const
 {
@@ -168,12 +338,17 @@ wxPoint CanvasPanel::CanvasToScreen(const wxPoint& canvasPos) const
 }
 
 //================= 添加元件 =================
-void CanvasPanel::AddElement(const CanvasElement& elem)
+ElementHandle CanvasPanel::AddElement(const CanvasElement& elem)
 {
-    m_elements.push_back(elem);
+    ElementHandle h = m_elements.Insert(elem);
+    m_netlist.AddElement(elem);
+    m_elementIndex.Insert(m_elements.size() - 1, elem.GetBounds());
+    m_pinIndex.Insert(m_elements.size() - 1, elem);
+    InvalidateTiles(elem.GetBounds());
     Refresh();
     MyLog("CanvasPanel::AddElement: <%s> total=%zu\n",
         elem.GetName().ToUTF8().data(), m_elements.size());
+    return h;
 }
 
 //================= 绘制 =================
@@ -181,79 +356,350 @@ void CanvasPanel::AddElement(const CanvasElement& elem)
 void CanvasPanel::OnPaint(wxPaintEvent&)
 {
     wxAutoBufferedPaintDC dc(this);
-    dc.Clear();
 
-    // 应用缩放和偏移
-    dc.SetUserScale(m_scale, m_scale);
-    dc.SetDeviceOrigin(m_offset.x, m_offset.y);  // 设置设备原点偏移
+    // 只重绘失效区域：逐块裁剪并缩小视口查询；块太多时退化为外接矩形
+    std::vector<wxRect> rects;
+    for (wxRegionIterator it(GetUpdateRegion()); it; ++it)
+        rects.push_back(it.GetRect());
+    if (rects.empty())
+        rects.push_back(wxRect(GetClientSize()));
+    else if (rects.size() > 8)
+        rects.assign(1, GetUpdateRegion().GetBox());
+
+    if (m_elements.size() + m_wires.size() >= m_workerThreshold)
+        SyncRenderWorker();
+    else if (m_renderWorker) {
+        m_renderWorker.reset();
+        m_frameBitmap = wxBitmap();
+        m_frameRequested = FrameKey();
+    }
 
-    // 1. 绘制网格（网格大小随缩放自适应）
-    const int grid = 20;
-    const wxColour c(240, 240, 240);
-    dc.SetPen(wxPen(c, 1));
-    // 计算可见区域的网格范围（基于缩放后的画布大小）
+    for (const wxRect& dirty : rects)
+        PaintArea(dc, dirty);
+}
+
+void CanvasPanel::SetRenderWorkerThreshold(size_t objects)
+{
+    m_workerThreshold = objects;
+    Refresh();
+}
+
+void CanvasPanel::SyncRenderWorker()
+{
+    if (!m_renderWorker) {
+        // 工作线程画完后通知界面线程整窗重绘
+        m_renderWorker = std::make_unique<RenderWorker>([this] { CallAfter([this] { Refresh(false); }); });
+    }
+
+    RenderedFrame frame;
+    if (m_renderWorker->TakeFrame(frame)) {
+        m_frameBitmap = wxBitmap(frame.image);
+        m_frameKey = { frame.version, frame.scale, frame.offset, frame.image.GetSize() };
+        m_frameGeometry = std::move(frame.geometry);
+    }
+
+    UpdateSnapshot();
+    const FrameKey want{ m_snapshot->version, m_scale, m_offset, GetClientSize() };
+    if ((m_frameBitmap.IsOk() && m_frameKey == want) || m_frameRequested == want) return;
+    m_renderWorker->Submit({ m_snapshot, m_scale, m_offset, want.size, GetDetailLevel() });
+    m_frameRequested = want;
+}
+
+// 快照只在静态内容变化后重建，平移、缩放、切换选中复用同一份
+void CanvasPanel::UpdateSnapshot()
+{
+    // 当前画在叠加层的元件和导线
+    ElementHandle floatingElement;
+    m_floatingWires.clear();
+    if (m_elements.IndexOf(m_movingElement) >= 0) {
+        floatingElement = m_movingElement;
+        for (const auto& aw : m_movingWires) m_floatingWires.push_back(aw.wire);
+    }
+    if (m_wires.IndexOf(m_editingWire) >= 0) m_floatingWires.push_back(m_editingWire);
+    const bool interacting = !floatingElement.IsNull() || !m_floatingWires.empty();
+
+    const bool simulating = m_simulator && m_simulator->IsBuilt();
+    auto colourOf = [&](int wireIdx) {
+        return simulating && wireIdx >= 0 ? SimValueColour(m_simulator->GetWireValue(wireIdx)) : wxColour(0, 0, 0);
+        };
+
+    // 拖动、编辑期间的修改都落在叠加层的那些对象上，几何沿用开始时的一份
+    const SceneGeometry* geo = m_snapshot ? m_snapshot->geometry.get() : nullptr;
+    if (geo && geo->floatingElement == floatingElement && geo->floatingWires == m_floatingWires
+        && (interacting || geo->sceneVersion == m_sceneVersion)) {
+        if (m_snapshot->colourVersion == m_colourVersion) return;
+        auto snap = std::make_shared<SceneSnapshot>();
+        snap->geometry = m_snapshot->geometry;
+        snap->wireColours.reserve(geo->wireHandles.size());
+        for (const WireHandle& h : geo->wireHandles) snap->wireColours.push_back(colourOf(m_wires.IndexOf(h)));
+        snap->colourVersion = m_colourVersion;
+        snap->version = ++m_snapshotSerial;
+        m_snapshot = std::move(snap);
+        return;
+    }
+
+    auto g = std::make_shared<SceneGeometry>();
+    g->sceneVersion = m_sceneVersion;
+    g->selected = m_selected;
+    g->floatingElement = floatingElement;
+    g->floatingWires = m_floatingWires;
+    const int selected = GetSelectedIndex();
+    const int moving = m_elements.IndexOf(floatingElement);
+    g->elements.reserve(m_elements.size());
+    for (size_t i = 0; i < m_elements.size(); ++i)
+        if ((int)i != selected && (int)i != moving) g->elements.push_back(m_elements[i]);
+    auto snap = std::make_shared<SceneSnapshot>();
+    g->wires.reserve(m_wires.size());
+    g->wireHandles.reserve(m_wires.size());
+    snap->wireColours.reserve(m_wires.size());
+    for (size_t i = 0; i < m_wires.size(); ++i) {
+        const WireHandle h = m_wires.HandleAt(i);
+        if (interacting && std::find(m_floatingWires.begin(), m_floatingWires.end(), h) != m_floatingWires.end())
+            continue;
+        g->wires.push_back(m_wires[i]);
+        g->wireHandles.push_back(h);
+        snap->wireColours.push_back(colourOf(static_cast<int>(i)));
+    }
+    snap->geometry = std::move(g);
+    snap->colourVersion = m_colourVersion;
+    snap->version = ++m_snapshotSerial;
+    m_snapshot = std::move(snap);
+}
+
+// 平移：已画好的内容直接滚动，只有新露出的条带会失效重绘
+void CanvasPanel::PanBy(const wxPoint& delta)
+{
+    if (delta.x == 0 && delta.y == 0) return;
+    m_offset += delta;
     wxSize sz = GetClientSize();
-    int maxX = static_cast<int>(sz.x / m_scale);  // 转换为画布坐标
-    int maxY = static_cast<int>(sz.y / m_scale);
-    for (int x = 0; x < maxX; x += grid)
-        dc.DrawLine(x, 0, x, maxY);
-    for (int y = 0; y < maxY; y += grid)
-        dc.DrawLine(0, y, maxX, y);
-
-    // 2. 绘制元素（元素坐标已在CanvasElement内部维护，缩放由DC自动处理）
-    for (size_t i = 0; i < m_elements.size(); ++i) {
-        m_elements[i].Draw(dc);
-        // 选中状态边框
-        if ((int)i == m_selectedIndex) {
-            wxRect b = m_elements[i].GetBounds();
-            dc.SetPen(wxPen(*wxRED, 2, wxPENSTYLE_DOT));
-            dc.SetBrush(*wxTRANSPARENT_BRUSH);
-            dc.DrawRectangle(b);
+    if (abs(delta.x) >= sz.x || abs(delta.y) >= sz.y) {
+        Refresh();
+        return;
+    }
+    ScrollWindow(delta.x, delta.y);
+}
+
+// 网格图块：若干个网格周期拼成整数像素宽的图块，贴图时不会累积误差
+// 当前缩放下找不到合适的周期时返回 false，由调用方逐条画线
+bool CanvasPanel::UpdateGridTile()
+{
+    if (m_gridTileScale == m_scale) return m_gridTile.IsOk();
+    m_gridTileScale = m_scale;
+    m_gridTile = wxBitmap();
+
+    const double period = 20.0 * m_scale;
+    int cells = 0;
+    for (int n = 1; n <= 32; ++n) {
+        double px = n * period;
+        if (std::fabs(px - std::round(px)) < 0.01) { cells = n; break; }
+    }
+    if (cells == 0) return false;
+    while (cells * period < 64) cells *= 2;
+    const int size = static_cast<int>(std::lround(cells * period));
+    if (size > 1024) return false;
+
+    const int lineWidth = std::max(1, static_cast<int>(std::lround(m_scale)));
+    m_gridTile = wxBitmap(size, size);
+    wxMemoryDC mdc(m_gridTile);
+    mdc.SetBackground(*wxWHITE_BRUSH);
+    mdc.Clear();
+    mdc.SetPen(*wxTRANSPARENT_PEN);
+    mdc.SetBrush(wxBrush(wxColour(240, 240, 240)));
+    for (int i = 0; i < cells; ++i) {
+        int at = static_cast<int>(std::lround(i * period));
+        mdc.DrawRectangle(at, 0, lineWidth, size);
+        mdc.DrawRectangle(0, at, size, lineWidth);
+    }
+    mdc.SelectObject(wxNullBitmap);
+    m_gridTilePx = size;
+    return true;
+}
+
+// 背景网格：设备坐标，画布原点在 origin，覆盖 area
+void CanvasPanel::DrawGrid(wxDC& dc, const wxRect& area, const wxPoint& origin)
+{
+    if (UpdateGridTile()) {
+        const int t = m_gridTilePx;
+        const int x0 = origin.x + FloorDiv(area.x - origin.x, t) * t;
+        const int y0 = origin.y + FloorDiv(area.y - origin.y, t) * t;
+        for (int y = y0; y <= area.GetBottom(); y += t)
+            for (int x = x0; x <= area.GetRight(); x += t)
+                dc.DrawBitmap(m_gridTile, x, y, false);
+        return;
+    }
+
+    // 无法拼成整数像素图块的缩放：只在 area 内逐条画线
+    dc.Clear();
+    const double period = 20.0 * m_scale;
+    const int lineWidth = std::max(1, static_cast<int>(std::lround(m_scale)));
+    dc.SetPen(*wxTRANSPARENT_PEN);
+    dc.SetBrush(wxBrush(wxColour(240, 240, 240)));
+    for (double k = std::ceil((area.x - lineWidth - origin.x) / period); ; ++k) {
+        int x = static_cast<int>(std::lround(k * period)) + origin.x;
+        if (x > area.GetRight()) break;
+        dc.DrawRectangle(x, area.y, lineWidth, area.height);
+    }
+    for (double k = std::ceil((area.y - lineWidth - origin.y) / period); ; ++k) {
+        int y = static_cast<int>(std::lround(k * period)) + origin.y;
+        if (y > area.GetBottom()) break;
+        dc.DrawRectangle(area.x, y, area.width, lineWidth);
+    }
+}
+
+// 静态内容：网格、未选中的元件、导线
+void CanvasPanel::DrawStatic(wxDC& dc, const wxRect& area, const wxPoint& origin)
+{
+    dc.SetUserScale(1.0, 1.0);
+    dc.SetDeviceOrigin(0, 0);
+    DrawGrid(dc, area, origin);
+
+    // 只画与 area 相交的
+    wxRect view(wxPoint(static_cast<int>(std::floor((area.GetLeft() - origin.x) / m_scale)),
+                        static_cast<int>(std::floor((area.GetTop() - origin.y) / m_scale))),
+                wxPoint(static_cast<int>(std::ceil((area.GetRight() + 1 - origin.x) / m_scale)),
+                        static_cast<int>(std::ceil((area.GetBottom() + 1 - origin.y) / m_scale))));
+    view.Inflate(4);
+
+    // 元件：先在设备坐标下贴缓存位图，无法缓存的随后按矢量绘制
+    // 缩得很小时只画包围盒，直接矢量绘制比贴图便宜
+    const DetailLevel detail = GetDetailLevel();
+    const int selected = GetSelectedIndex();
+    m_elementIndex.Query(view, m_visibleElements);
+    m_vectorElements.clear();
+    for (size_t i : m_visibleElements) {
+        if ((int)i == selected) continue;
+        const SpriteCache::Sprite* sprite =
+            detail == DetailLevel::Box ? nullptr : m_sprites.Get(m_elements[i], m_scale, detail);
+        if (!sprite) {
+            m_vectorElements.push_back(i);
+            continue;
         }
+        const wxPoint pos = m_elements[i].GetPos();
+        const int x = static_cast<int>(pos.x * m_scale + origin.x);
+        const int y = static_cast<int>(pos.y * m_scale + origin.y);
+        dc.DrawBitmap(sprite->bitmap, x - sprite->origin.x, y - sprite->origin.y, true);
+    }
+    dc.SetUserScale(m_scale, m_scale);
+    dc.SetDeviceOrigin(origin.x, origin.y);
+    for (size_t i : m_vectorElements)
+        m_elements[i].Draw(dc, detail);
+
+    // 导线（坐标基于画布，缩放由DC处理）
+    const bool simulating = m_simulator && m_simulator->IsBuilt();
+    const wxColour black(0, 0, 0);
+    m_wireIndex.Query(view, m_visibleWires);
+    for (size_t i : m_visibleWires)
+        m_wireBatch.Add(m_wires[i], simulating ? SimValueColour(m_simulator->GetWireValue(i)) : black);
+    m_wireBatch.Flush(dc, detail != DetailLevel::Full ? 1 : 2);
+}
+
+void CanvasPanel::PaintArea(wxDC& dc, const wxRect& dirty)
+{
+    dc.DestroyClippingRegion();
+    dc.SetUserScale(1.0, 1.0);
+    dc.SetDeviceOrigin(0, 0);
+    dc.SetClippingRegion(dirty);
+
+    // 1. 静态内容：贴缓存图块；放得太大时图块过大，直接绘制
+    if (m_tileScale != m_scale) {
+        m_tiles.clear();
+        m_tilePixels = 0;
+        m_tileScale = m_scale;
+    }
+    const double t = kTileSize * m_scale;
+    if (m_renderWorker) {
+        // 后台画好的最新一帧：偏移变了就按新偏移错开贴上，尚未覆盖的地方先露出网格；
+        // 缩放不同的旧帧不贴，等新帧到达
+        DrawGrid(dc, dirty, m_offset);
+        if (m_frameBitmap.IsOk() && m_frameKey.scale == m_scale)
+            dc.DrawBitmap(m_frameBitmap, m_offset.x - m_frameKey.offset.x, m_offset.y - m_frameKey.offset.y, false);
+    }
+    else if (t <= kMaxTilePx) {
+        // 按 floor 取整的图块边缘可能落在估算编号的下一块，末端多查一块
+        const int tx0 = static_cast<int>(std::floor((dirty.GetLeft() - m_offset.x) / t));
+        const int tx1 = static_cast<int>(std::floor((dirty.GetRight() - m_offset.x) / t)) + 1;
+        const int ty0 = static_cast<int>(std::floor((dirty.GetTop() - m_offset.y) / t));
+        const int ty1 = static_cast<int>(std::floor((dirty.GetBottom() - m_offset.y) / t)) + 1;
+        for (int ty = ty0; ty <= ty1; ++ty)
+            for (int tx = tx0; tx <= tx1; ++tx) {
+                wxRect r = TilePixelRect(tx, ty);
+                r.Offset(m_offset);
+                if (!r.Intersects(dirty)) continue;
+                dc.DrawBitmap(GetTile(tx, ty), r.x, r.y, false);
+            }
+    }
+    else {
+        DrawStatic(dc, dirty, m_offset);
     }
 
-    // 3. 绘制导线（导线坐标基于画布，缩放由DC处理）
-    for (const auto& w : m_wires) w.Draw(dc);
+    // 2. 叠加层：选中元件、临时导线、悬停标记（画布坐标）
+    dc.SetUserScale(m_scale, m_scale);
+    dc.SetDeviceOrigin(m_offset.x, m_offset.y);
+    wxRect view(ScreenToCanvas(dirty.GetTopLeft()),
+        ScreenToCanvas(wxPoint(dirty.GetRight() + 1, dirty.GetBottom() + 1)));
+    view.Inflate(4);
+
+    const int selected = GetSelectedIndex();
+    if (selected != -1 && m_elements[selected].GetBounds().Intersects(view)) {
+        m_elements[selected].Draw(dc);
+        dc.SetPen(wxPen(*wxRED, 2, wxPENSTYLE_DOT));
+        dc.SetBrush(*wxTRANSPARENT_BRUSH);
+        dc.DrawRectangle(m_elements[selected].GetBounds());
+    }
     if (m_wireMode == WireMode::DragNew) m_tempWire.Draw(dc);
 
-    // 4. 悬停引脚：绿色空心圆
+    // 当前帧里没有的内容（生成快照时选中的元件、拖动中的元件、相连或编辑中的导线）；
+    // 拖动结束、切换选中后新帧到达前也照样补画
+    if (m_renderWorker && m_frameBitmap.IsOk() && m_frameGeometry) {
+        const SceneGeometry& geo = *m_frameGeometry;
+        const ElementHandle missing[2] = { geo.selected,
+            geo.floatingElement == geo.selected ? ElementHandle() : geo.floatingElement };
+        for (const ElementHandle& h : missing) {
+            const int i = m_elements.IndexOf(h);
+            if (i >= 0 && i != selected && m_elements[i].GetBounds().Intersects(view))
+                m_elements[i].Draw(dc);
+        }
+        const bool simulating = m_simulator && m_simulator->IsBuilt();
+        for (const WireHandle& h : geo.floatingWires) {
+            const int i = m_wires.IndexOf(h);
+            if (i < 0 || !m_wires[i].GetBounds().Intersects(view)) continue;
+            m_wires[i].Draw(dc, simulating ? SimValueColour(m_simulator->GetWireValue(i)) : *wxBLACK);
+        }
+    }
+
+    // 悬停引脚：绿色空心圆
     if (m_hoverPinIdx != -1) {
         dc.SetBrush(*wxTRANSPARENT_BRUSH);              // 不填充 → 空心
         dc.SetPen(wxPen(wxColour(0, 255, 0), 1));       // 绿色边框，线宽 2
         dc.DrawCircle(m_hoverPinPos, 3);                // 半径 3 像素
     }
 
-    if (m_hoverCellIdx != -1) {
-        /*MyLog("DRAW GREEN CELL: wire=%zu cell=%zu  pos=(%d,%d)\n",
-            m_hoverCellWire, m_hoverCellIdx,
-            m_hoverCellPos.x, m_hoverCellPos.y);*/
+    if (m_hoverSegIdx != -1) {
         dc.SetBrush(*wxTRANSPARENT_BRUSH);
         dc.SetPen(wxPen(wxColour(0, 255, 0), 1));
-        dc.DrawCircle(m_hoverCellPos, 3);
+        dc.DrawCircle(m_hoverSegPos, 3);
     }
 }
 
 //================= 放置元件 =================
 void CanvasPanel::PlaceElement(const wxString& name, const wxPoint& pos)
+{
+    PlaceElement(FindComponentId(name), pos);
+}
+
+void CanvasPanel::PlaceElement(ComponentId id, const wxPoint& pos)
 {
     extern std::vector<CanvasElement> g_elements;
-    auto it = std::find_if(g_elements.begin(), g_elements.end(),
-        [&](const CanvasElement& e) { return e.GetName() == name; });
-    if (it == g_elements.end()) return;
-    CanvasElement clone = *it;
+    if (id >= g_elements.size()) return;
+    CanvasElement clone = g_elements[id];
     clone.SetPos(pos);
     AddElement(clone);
 }
 // 修改：HitTest使用画布坐标判断
 int CanvasPanel::HitTest(const wxPoint& pt)  // pt已转换为画布坐标
 {
-    for (size_t i = 0; i < m_elements.size(); ++i) {
-        // 元素的边界是画布坐标，直接比较
-        if (m_elements[i].GetBounds().Contains(pt)) {
-            return i;
-        }
-    }
-    return -1;
+    // 元素的边界是画布坐标，由网格索引直接查询
+    return m_elementIndex.HitTest(pt);
 }
 
 //================= 吸附：网格+引脚 =================
@@ -263,79 +709,51 @@ wxPoint CanvasPanel::Snap(const wxPoint& raw, bool* snapped)
     const int grid = 20;
     wxPoint s((raw.x + grid / 2) / grid * grid, (raw.y + grid / 2) / grid * grid);
 
-    // 吸引脚（半径 8 px）
-    for (const auto& elem : m_elements) {
-        auto testPins = [&](const auto& pins) {
-            for (const auto& pin : pins) {
-                wxPoint p = elem.GetPos() + wxPoint(pin.pos.x, pin.pos.y);
-                if (abs(raw.x - p.x) <= 8 && abs(raw.y - p.y) <= 8) {
-                    *snapped = true;
-                    return p;
-                }
-            }
-            return wxPoint{};
-            };
-        wxPoint in = testPins(elem.GetInputPins());
-        if (in != wxPoint{}) return in;
-        wxPoint out = testPins(elem.GetOutputPins());
-        if (out != wxPoint{}) return out;
+    // 吸引脚（半径 8 px）：只查引脚索引里光标附近的格子
+    const PinIndex::Pin* best = nullptr;
+    m_pinIndex.ForEachNear(raw, 8, [&](const PinIndex::Pin& p) {
+        if (abs(raw.x - p.pos.x) <= 8 && abs(raw.y - p.pos.y) <= 8 &&
+            (!best || PinIndex::Precedes(p, *best)))
+            best = &p;
+        });
+    if (best) {
+        *snapped = true;
+        return best->pos;
     }
     return s;
 }
-
-// 返回悬停到的引脚索引（-1 表示无），同时输出类型和世界坐标
 int CanvasPanel::HitHoverPin(const wxPoint& raw, bool* isInput, wxPoint* worldPos)
 {
-    for (size_t i = 0; i < m_elements.size(); ++i) {
-        const auto& elem = m_elements[i];
-        // 输入引脚尖端（突出 1 px）
-        for (size_t p = 0; p < elem.GetInputPins().size(); ++p) {
-            wxPoint tip = elem.GetPos() + wxPoint(elem.GetInputPins()[p].pos.x - 1,
-                elem.GetInputPins()[p].pos.y);
-            if (abs(raw.x - tip.x) <= 4 && abs(raw.y - tip.y) <= 4) {
-                *isInput = true;
-                *worldPos = tip;
-                return p;
-            }
-        }
-        // 输出引脚尖端（突出 1 px）
-        for (size_t p = 0; p < elem.GetOutputPins().size(); ++p) {
-            wxPoint tip = elem.GetPos() + wxPoint(elem.GetOutputPins()[p].pos.x + 1,
-                elem.GetOutputPins()[p].pos.y);
-            if (abs(raw.x - tip.x) <= 4 && abs(raw.y - tip.y) <= 4) {
-                *isInput = false;
-                *worldPos = tip;
-                return p;
-            }
+    // 引脚尖端：输入向左、输出向右突出 1 px，容差 4 px
+    const PinIndex::Pin* best = nullptr;
+    wxPoint bestTip;
+    m_pinIndex.ForEachNear(raw, 5, [&](const PinIndex::Pin& p) {
+        const wxPoint tip = p.pos + wxPoint(p.isInput ? -1 : 1, 0);
+        if (abs(raw.x - tip.x) <= 4 && abs(raw.y - tip.y) <= 4 &&
+            (!best || PinIndex::Precedes(p, *best))) {
+            best = &p;
+            bestTip = tip;
         }
-    }
-    return -1;
+        });
+    if (!best) return -1;
+    *isInput = best->isInput;
+    *worldPos = bestTip;
+    return static_cast<int>(best->pin);
 }
 
-int CanvasPanel::HitHoverCell(const wxPoint& raw, int* wireIdx, int* cellIdx, wxPoint* cellPos)
+// 返回悬停到的导线线段索引（-1 表示无）：只查询光标附近格子里的线段，按精确距离判断
+int CanvasPanel::HitHoverSegment(const wxPoint& raw, int* wireIdx, int* segIdx, wxPoint* segPos)
 {
-    /*MyLog("HitHoverCell: (%d,%d)\n", raw.x, raw.y);
-    for (size_t w = 0; w < m_wires.size(); ++w) {
-        const auto& wire = m_wires[w];
-        for (size_t c = 0; c < wire.cells.size(); ++c) {
-            MyLog("  wire[%zu] cell[%zu] = (%d,%d)\n",
-                w, c, wire.cells[c].x, wire.cells[c].y);
-        }
-    }*/
-    for (size_t w = 0; w < m_wires.size(); ++w) {
-        const auto& wire = m_wires[w];
-        for (size_t c = 0; c < wire.cells.size(); ++c) {
-            if (abs(raw.x - wire.cells[c].x) <= 2 &&
-                abs(raw.y - wire.cells[c].y) <= 2) {
-                *wireIdx = w;
-                *cellIdx = c;
-                *cellPos = wire.cells[c];
-                return c;
-            }
-        }
+    SegmentIndex::Hit hit;
+    if (!m_wireIndex.HitTest(raw, 2, &hit)) {
+        *wireIdx = -1;
+        *segIdx = -1;
+        return -1;
     }
-    return -1;
-
+    *wireIdx = hit.wire;
+    *segIdx = hit.seg;
+    *segPos = hit.pos;
+    return hit.seg;
 }
 
 // 清理与指定元件关联的导线
@@ -345,71 +763,181 @@ void CanvasPanel::ClearElementWires(size_t elemIndex) {
     const auto& elem = m_elements[elemIndex];
     std::vector<size_t> wiresToRemove;
 
-    // 收集所有与该元件引脚相连的导线
-    for (size_t w = 0; w < m_wires.size(); ++w) {
-        const auto& wire = m_wires[w];
-        if (wire.pts.empty()) continue;
-
-        // 检查导线起点是否连接到元件引脚
-        if (wire.pts.front().type == CPType::Pin) {
-            wxPoint startPos = wire.pts.front().pos;
-            for (const auto& pin : elem.GetInputPins()) {
-                wxPoint pinPos = elem.GetPos() + wxPoint(pin.pos.x, pin.pos.y);
-                if (startPos == pinPos) {
-                    wiresToRemove.push_back(w);
-                    break;
-                }
-            }
-            for (const auto& pin : elem.GetOutputPins()) {
-                wxPoint pinPos = elem.GetPos() + wxPoint(pin.pos.x, pin.pos.y);
-                if (startPos == pinPos) {
-                    wiresToRemove.push_back(w);
-                    break;
-                }
-            }
-        }
-
-        // 检查导线终点是否连接到元件引脚
-        if (wire.pts.size() > 1 && wire.pts.back().type == CPType::Pin) {
-            wxPoint endPos = wire.pts.back().pos;
-            for (const auto& pin : elem.GetInputPins()) {
-                wxPoint pinPos = elem.GetPos() + wxPoint(pin.pos.x, pin.pos.y);
-                if (endPos == pinPos) {
-                    wiresToRemove.push_back(w);
-                    break;
-                }
-            }
-            for (const auto& pin : elem.GetOutputPins()) {
-                wxPoint pinPos = elem.GetPos() + wxPoint(pin.pos.x, pin.pos.y);
-                if (endPos == pinPos) {
-                    wiresToRemove.push_back(w);
-                    break;
-                }
-            }
-        }
-    }
-
-    // 反向删除导线（避免迭代器失效）
+    // 收集所有与该元件引脚相连的导线（由网表按引脚查询）
+    std::vector<std::pair<size_t, size_t>> ends;
+    for (size_t p = 0; p < elem.GetInputPins().size(); ++p)
+        m_netlist.GetPinWires(elemIndex, true, p, ends);
+    for (size_t p = 0; p < elem.GetOutputPins().size(); ++p)
+        m_netlist.GetPinWires(elemIndex, false, p, ends);
+    for (const auto& e : ends)
+        wiresToRemove.push_back(e.first);
+
+    // 从大到小删除：被搬到空位的总是末尾、下标更大的导线，不会是待删的；
+    // 两端都接在该元件上的导线只删一次
     std::sort(wiresToRemove.rbegin(), wiresToRemove.rend());
+    wiresToRemove.erase(std::unique(wiresToRemove.begin(), wiresToRemove.end()), wiresToRemove.end());
     for (size_t idx : wiresToRemove) {
         if (idx < m_wires.size()) {
-            m_wires.erase(m_wires.begin() + idx);
+            EraseWire(idx);
         }
     }
 }
 
+// 删除一根导线：去掉与它有关的 T 型连接；其他导线的句柄不受影响
+void CanvasPanel::EraseWire(size_t wireIdx) {
+    if (wireIdx >= m_wires.size()) return;
+    const WireHandle h = m_wires.HandleAt(wireIdx);
+    InvalidateTiles(m_wires[wireIdx].GetBounds());
+    m_wires.EraseAt(wireIdx);
+    m_netlist.RemoveWire(wireIdx);
+    m_wireIndex.Remove(wireIdx);
+    m_wireJunctions.RemoveWire(h);
+}
+
+std::vector<ControlPoint> CanvasPanel::RouteWire(const ControlPoint& start, const ControlPoint& end, int ignoreWire)
+{
+    std::vector<ControlPoint> pts;
+    m_router.Route(start, end, PinDirection::Right, PinDirection::Left, m_elementIndex, &m_wireIndex, ignoreWire, pts);
+    return pts;
+}
+
+//================= 拖动元件时的导线 =================
+void CanvasPanel::UpdateMovingWires(bool fullRoute)
+{
+    int elemIdx = m_elements.IndexOf(m_movingElement);
+    if (elemIdx < 0) return;
+    const CanvasElement& elem = m_elements[elemIdx];
+    for (const auto& aw : m_movingWires) {
+        int wireIdx = m_wires.IndexOf(aw.wire);
+        if (wireIdx < 0) continue;
+        const auto& pins = aw.isInput ? elem.GetInputPinWorld() : elem.GetOutputPinWorld();
+        if (aw.pinIdx >= pins.size()) continue;
+
+        Wire& wire = m_wires[wireIdx];
+        RefreshWire(wireIdx);   // 旧位置
+        if (aw.ptIdx == 0)
+            wire.pts.front().pos = pins[aw.pinIdx];
+        else
+            wire.pts.back().pos = pins[aw.pinIdx];
+        wire.pts = fullRoute ? RouteWire(wire.pts.front(), wire.pts.back(), wireIdx)
+                             : Wire::RouteL(wire.pts.front(), wire.pts.back());
+        UpdateWire(wireIdx);
+        RefreshWire(wireIdx);
+    }
+}
+
+void CanvasPanel::ScheduleReroute()
+{
+    m_rerouteTimer.StartOnce(kRerouteDelayMs);
+}
+
+void CanvasPanel::FinishMovingWires()
+{
+    m_rerouteTimer.Stop();
+    UpdateMovingWires(true);
+    m_movingWires.clear();
+    m_movingElement = ElementHandle();
+}
+
+
+void CanvasPanel::OnRerouteTimer(wxTimerEvent&)
+{
+    if (!m_movingWires.empty()) UpdateMovingWires(true);
+}
+
+//================= 编辑（同步维护网表） =================
+void CanvasPanel::MoveElement(size_t elemIdx, const wxPoint& pos) {
+    if (elemIdx >= m_elements.size()) return;
+    // 选中的元件画在叠加层，不在图块里
+    // 后台快照可能是选中之前生成的，里面还有它，版本照样要变
+    const bool inTiles = (int)elemIdx != GetSelectedIndex();
+    if (inTiles) InvalidateTiles(m_elementIndex.GetBounds(elemIdx));
+    else ++m_sceneVersion;
+    m_elements[elemIdx].SetPos(pos);
+    m_netlist.MoveElement(elemIdx, m_elements[elemIdx]);
+    m_elementIndex.Update(elemIdx, m_elements[elemIdx].GetBounds());
+    m_pinIndex.Update(elemIdx, m_elements[elemIdx]);
+    if (inTiles) InvalidateTiles(m_elements[elemIdx].GetBounds());
+}
+
+void CanvasPanel::UpdateWire(size_t wireIdx) {
+    if (wireIdx >= m_wires.size()) return;
+    InvalidateTiles(m_wireIndex.GetBounds(wireIdx));   // 索引里还是旧的控制点
+    m_netlist.UpdateWire(wireIdx, m_wires[wireIdx]);
+    m_wireIndex.Update(wireIdx, m_wires[wireIdx]);
+    InvalidateTiles(m_wires[wireIdx].GetBounds());
+
+    // 它作为端点一侧或被接一侧的 T 型连接都可能失效，按新形状重新识别
+    m_wireJunctions.RemoveWire(m_wires.HandleAt(wireIdx));
+    DetectTJunctions(wireIdx);
+}
+
+void CanvasPanel::EraseElement(size_t elemIdx) {
+    if (elemIdx >= m_elements.size()) return;
+    InvalidateTiles(m_elements[elemIdx].GetBounds());
+    m_elements.EraseAt(elemIdx);
+    m_netlist.RemoveElement(elemIdx);
+    m_elementIndex.Remove(elemIdx);
+    m_pinIndex.Remove(elemIdx);
+}
+
+// 只有线段与这根导线相交的导线才可能和它构成 T 型连接：由线段索引逐段查出
+void CanvasPanel::DetectTJunctions(size_t wireIdx) {
+    if (wireIdx >= m_wires.size()) return;
+    const auto& pts = m_wires[wireIdx].pts;
+    std::vector<size_t> candidates, hits;
+    for (size_t i = 1; i < pts.size(); ++i) {
+        const wxPoint& a = pts[i - 1].pos;
+        const wxPoint& b = pts[i].pos;
+        m_wireIndex.Query(wxRect(wxPoint(std::min(a.x, b.x), std::min(a.y, b.y)),
+            wxPoint(std::max(a.x, b.x), std::max(a.y, b.y))), hits);
+        candidates.insert(candidates.end(), hits.begin(), hits.end());
+    }
+    std::sort(candidates.begin(), candidates.end());
+    candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
+    std::vector<WireWireAnchor> found;
+    Netlist::FindTJunctions(m_wires.Values(), wireIdx, candidates, found);
+    for (const auto& a : found) {
+        m_wireJunctions.Add({ m_wires.HandleAt(a.srcWire), a.srcPt, m_wires.HandleAt(a.dstWire), a.dstSeg });
+        m_netlist.AddAnchor(a);
+    }
+}
+
+void CanvasPanel::DetectTJunctions() {
+    std::vector<WireWireAnchor> found;
+    Netlist::FindTJunctions(m_wires.Values(), found);
+    m_wireJunctions.clear();
+    for (const auto& a : found)
+        m_wireJunctions.Add({ m_wires.HandleAt(a.srcWire), a.srcPt, m_wires.HandleAt(a.dstWire), a.dstSeg });
+    RebuildNetlist();
+}
+
+// 网表按下标工作：把句柄形式的 T 型连接换算成当前下标
+void CanvasPanel::RebuildNetlist() {
+    std::vector<WireWireAnchor> anchors;
+    anchors.reserve(m_wireJunctions.size());
+    m_wireJunctions.ForEach([&](const WireJunction& j) {
+        int src = m_wires.IndexOf(j.srcWire), dst = m_wires.IndexOf(j.dstWire);
+        if (src < 0 || dst < 0) return;
+        anchors.push_back({ (size_t)src, j.srcPt, (size_t)dst, j.dstSeg });
+        });
+    m_netlist.Build(m_elements.Values(), m_wires.Values(), anchors);
+}
+
 // 删除选中的元件及关联导线
 void CanvasPanel::DeleteSelectedElement() {
-    if (m_selectedIndex == -1) return; // 无选中元件
+    const int selected = GetSelectedIndex();
+    if (selected == -1) return; // 无选中元件
 
-    // 1. 清理关联的导线
-    ClearElementWires(m_selectedIndex);
+    // 1. 清理关联的导线（删导线不影响元件下标）
+    ClearElementWires(selected);
 
     // 2. 删除选中的元件
-    m_elements.erase(m_elements.begin() + m_selectedIndex);
+    EraseElement(selected);
 
     // 3. 重置选中状态
-    m_selectedIndex = -1;
+    m_selected = ElementHandle();
     m_isDragging = false;
     m_movingWires.clear();
 
@@ -421,13 +949,13 @@ void CanvasPanel::DeleteSelectedElement() {
 
     // 添加这些公有方法
     void CanvasPanel::ClearSelection() {
-        m_selectedIndex = -1;
+        SetSelected(ElementHandle());
         Refresh();
     }
 
     void CanvasPanel::SetSelectedIndex(int index) {
         if (index >= 0 && index < (int)m_elements.size()) {
-            m_selectedIndex = index;
+            SetSelected(m_elements.HandleAt(index));
             Refresh();
         }
     }
@@ -1,34 +1,62 @@
 #pragma once
 #include <wx/wx.h>
 #include <vector>
+#include <unordered_map>
 #include "CanvasElement.h"
 #include "Wire.h"          //  
+#include "Simulator.h"
+#include "Netlist.h"
+#include "SpatialHash.h"
+#include "SlotMap.h"
+#include "SpriteCache.h"
+#include "RenderWorker.h"
+#include "WireRouter.h"
+#include "WireJunctions.h"
 
 
 /* ϶ʱҪµ + ӦϢ */
 struct WireAnchor {
-    size_t wireIdx;   // 
+    WireHandle wire;  // 
     size_t ptIdx;     // ߵڼƵ㣨0  
     bool   isInput;   // Ԫ뻹
     size_t pinIdx;    // Ԫ
 };
 
 
+
 class CanvasPanel : public wxPanel
 {
 public:
     CanvasPanel(wxWindow* parent);
-    void AddElement(const CanvasElement& elem);
+    ElementHandle AddElement(const CanvasElement& elem);
     void PlaceElement(const wxString& name, const wxPoint& pos);
+    void PlaceElement(ComponentId id, const wxPoint& pos);
 
 
     // ط
     float GetScale() const { return m_scale; }  // ȡǰű
     void SetScale(float scale);                 // űˢ
 
+    // ϸڲΣŵ outlineBelow ʱֺš߻ɵߣ
+    //  boxBelow ʱԪֻİΧ
+    void SetDetailThresholds(float outlineBelow, float boxBelow);
+    DetailLevel GetDetailLevel() const;
+    float m_lodOutlineBelow = 0.5f;
+    float m_lodBoxBelow = 0.2f;
+
     // תĻ <-> ꣬ţ
     wxPoint ScreenToCanvas(const wxPoint& screenPos) const;
     wxPoint CanvasToScreen(const wxPoint& canvasPos) const;
+    wxRect  GetViewRect() const;   // ڿɼ򣨻꣩
+    void    PanBy(const wxPoint& delta);   // ƽ m_offset ѻƵ
+
+    // ֲػ棺ѻľΣ߿㵽Ļػ
+    void RefreshCanvasRect(const wxRect& canvasRect);
+    void RefreshWire(size_t wireIdx);
+    void RefreshElement(size_t elemIdx);                  // ѡп
+    static wxRect HoverMarkRect(const wxPoint& p) { return wxRect(p.x - 4, p.y - 4, 9, 9); }
+    // ̬仯ֵˢµɫȫͼ鲢ػ
+    void RefreshScene();
 
     wxPoint m_offset;          // ƫƽ꣩
     bool m_isPanning;          // Ƿקƽ
@@ -45,44 +73,84 @@ public:
     void OnKeyDown(wxKeyEvent& evt);
     void OnMouseWheel(wxMouseEvent& evt);  
 
-    const std::vector<CanvasElement>& GetElements() const { return m_elements; }
+    const std::vector<CanvasElement>& GetElements() const { return m_elements.Values(); }
     // ջķ
     void ClearAll() {
         m_elements.clear();
         m_wires.clear();
-        m_selectedIndex = -1;
-        Refresh();
+        m_wireJunctions.clear();
+        m_netlist.Clear();
+        m_elementIndex.Clear();
+        m_wireIndex.Clear();
+        m_pinIndex.Clear();
+        m_selected = ElementHandle();
+        RefreshScene();   // ͼͬؼһ
     }
 
     // ӵߵķ
-    void AddWire(const Wire& wire) {
-        m_wires.push_back(wire);
+    WireHandle AddWire(const Wire& wire) {
+        WireHandle h = m_wires.Insert(wire);
+        m_netlist.AddWire(wire);
+        m_wireIndex.Insert(m_wires.size() - 1, wire);
+        InvalidateTiles(wire.GetBounds());
         Refresh();
+        return h;
     }
 
+    // ޸ͬʱάⲿĶԪλ/״Ӧ
+    // ǵǰ±ꣻɾһƵλ뱣
+    void MoveElement(size_t elemIdx, const wxPoint& pos);
+    void UpdateWire(size_t wireIdx);              // m_wires[wireIdx] ĿƵѸı
+    void EraseElement(size_t elemIdx);            // ֻɾԪɾ
+    void DetectTJunctions(size_t wireIdx);        // ¼õйص T 
+    void DetectTJunctions();                      // ʶȫ T Ӳؽ
 
 
-    // ¶ⲿ/ʹ
-    const std::vector<Wire>& GetWires() const { return m_wires; }
 
+    // ¶ⲿ/ʹ
+    const std::vector<Wire>& GetWires() const { return m_wires.Values(); }
+
+    // ֻڰźֵɫnullptr ʾδڷ
+    void SetSimulator(const Simulator* sim) { m_simulator = sim; RefreshScene(); }
+    void RefreshSimWires();   // ƽֻػֵ仯ĵ
+    const Simulator* m_simulator = nullptr;
+    std::vector<size_t> m_simWires;
+
+    // ͨ༭άRebuildNetlist ȫؽ
+    void RebuildNetlist();
+    const Netlist& GetNetlist() const { return m_netlist; }
+    Netlist m_netlist;
+
+    // ԪΧе20 px ӣв
+    SpatialHash m_elementIndex;
+    // ߶εͣ/
+    SegmentIndex m_wireIndex;
+    // λõͣ
+    PinIndex m_pinIndex;
+
+    // ϲߣųҡų󣩣ignoreWire Ϊ²ߵĵ
+    std::vector<ControlPoint> RouteWire(const ControlPoint& start, const ControlPoint& end, int ignoreWire = -1);
+    WireRouter m_router;
 
     void DeleteSelectedElement();
 
 
 public:
     /* ---------- ԭԪ ---------- */
-    std::vector<CanvasElement> m_elements;
-    int  m_selectedIndex = -1;
+    SlotMap<CanvasElement> m_elements;
+    ElementHandle m_selected;   // ѡеԪɾԶʧЧ
+    int  GetSelectedIndex() const { return m_elements.IndexOf(m_selected); }
     bool m_isDragging = false;
     wxPoint m_dragStartPos;
     wxPoint m_elementStartPos;
 
 
     void ClearElementWires(size_t elemIndex);
+    void EraseWire(size_t wireIdx);   // ɾ߼йص T 
 
 
     /* ----------  ---------- */
-    std::vector<Wire> m_wires;   // Ѷ͵
+    SlotMap<Wire> m_wires;       // Ѷ͵
     Wire m_tempWire;             // ϶/Ԥ
     enum class WireMode { Idle, DragNew, DragMove };
     WireMode m_wireMode = WireMode::Idle;
@@ -95,6 +163,68 @@ public:
 
     /* ---------- ԭк ---------- */
     void OnPaint(wxPaintEvent& evt);
+    void PaintArea(wxDC& dc, const wxRect& dirty);   // dirty ΪĻ
+    // ̬ݣδѡеԪߣ p 豸 p*m_scale+origin
+    // area ΪҪ豸귶Χ
+    void DrawStatic(wxDC& dc, const wxRect& area, const wxPoint& origin);
+    void DrawGrid(wxDC& dc, const wxRect& area, const wxPoint& origin);
+    bool UpdateGridTile();
+    wxBitmap m_gridTile;          // ǰŵͼ
+    float    m_gridTileScale = 0; // ͼӦţ0 ʾδ
+    int      m_gridTilePx = 0;    // ͼ߳أ
+    std::vector<size_t> m_visibleElements;   // OnPaint ӿڲѯ
+    std::vector<size_t> m_visibleWires;
+    std::vector<size_t> m_vectorElements;    // ҪʸƵԪ
+    WireBatch m_wireBatch;                   // ߰ɫƣ
+    SpriteCache m_sprites;                   // Ԫλͼ棨Ԫ//ţ
+
+    // ̬ͼ黺棺 kTileSize λֿ飬δѡеԪ͵ԤȻλͼ
+    // ༭ֻðΧиǵͼʧЧʱߡͣǺѡԪÿεͼ
+    static constexpr int    kTileSize = 256;
+    static constexpr int    kMaxTilePx = 1024;              // ߳ޣŵøʱֱӻ
+    static constexpr size_t kTileBudget = 32u << 20;        // ͼޣʱδõ
+    struct SceneTile {
+        wxBitmap bitmap;
+        uint64_t lastUse = 0;
+    };
+    std::unordered_map<uint64_t, SceneTile> m_tiles;
+    float    m_tileScale = 0;       // ͼӦ
+    size_t   m_tilePixels = 0;
+    uint64_t m_tileClock = 0;
+    void InvalidateTiles(const wxRect& canvasRect);   // ̬ݱ仯汾һǵͼ
+    void DropTiles(const wxRect& canvasRect);         // ֻͼ飨ѡл߱ɫ汾
+    wxRect TilePixelRect(int tx, int ty) const;   // ͼطΧ m_offset
+    const wxBitmap& GetTile(int tx, int ty);
+    void SetSelected(ElementHandle h);            // ѡеԪͼлʱ¾λʧЧ
+
+    // ̨դԪ+ﵽֵʱ̬ݽ̻߳
+    // ֻ߳»õһ֡͵Ӳ㣬󳡾ػҲ괦
+    void SetRenderWorkerThreshold(size_t objects);   // SIZE_MAX ʾ
+    size_t   m_workerThreshold = 20000;
+    uint64_t m_sceneVersion = 1;                     // ̬ݵ״ÿα仯һ
+    uint64_t m_colourVersion = 1;                    // 浼ɫÿα仯һ
+    uint64_t m_snapshotSerial = 0;
+    std::unique_ptr<RenderWorker>        m_renderWorker;
+    std::shared_ptr<const SceneSnapshot> m_snapshot;
+    struct FrameKey {
+        uint64_t version = 0;
+        float    scale = 0;
+        wxPoint  offset;
+        wxSize   size;
+        bool operator==(const FrameKey& o) const
+        {
+            return version == o.version && scale == o.scale && offset == o.offset && size == o.size;
+        }
+    };
+    wxBitmap m_frameBitmap;     // ȡصһ֡
+    FrameKey m_frameKey;        // ֡ӦĲ
+    FrameKey m_frameRequested;  // ύ
+    void SyncRenderWorker();    // ȡ֡ǰ֡ûͬ;ʱύ
+    // ϶Ԫ༭ڼ伸ֻڿʼʱһΣϵԪߺͱ༭еĵ
+    // նڵӲ㣻лѡвؽֻе߱ɫʱ¿ԭļ
+    void UpdateSnapshot();
+    std::shared_ptr<const SceneGeometry> m_frameGeometry;   // ǰ֡
+    std::vector<WireHandle> m_floatingWires;                 // 
     int  HitTest(const wxPoint& pt);
 
     /* ----------  ---------- */
@@ -102,16 +232,29 @@ public:
     wxPoint Snap(const wxPoint& raw, bool* snapped);
 
     std::vector<WireAnchor> m_movingWires;
+    ElementHandle m_movingElement;          // m_movingWires Ԫ
+
+    // ϶Ԫʱ L Ԥͣ kRerouteDelayMs ɿ
+    void UpdateMovingWires(bool fullRoute);   // ˵Ƶŵǰλò
+    void ScheduleReroute();                   // ¿ʼͣټʱ
+    void FinishMovingWires();                 // ֹͣʱ߲ m_movingWires
+    // ڱ༭ƵĵߣЧʾ༭༭ڼڵӲ
+    void SetEditingWire(WireHandle h) { m_editingWire = h; }
+    WireHandle m_editingWire;
+    void OnRerouteTimer(wxTimerEvent& evt);
+    static constexpr int kRerouteDelayMs = 150;
+    enum { ID_REROUTE_TIMER = wxID_HIGHEST + 1 };
+    wxTimer m_rerouteTimer;
 
     int m_hoverPinIdx=-1;
     bool m_hoverIsInput=false;
     wxPoint m_hoverPinPos;
     int  HitHoverPin(const wxPoint& raw, bool* isInput, wxPoint* worldPos);
 
-    int  m_hoverCellWire = -1;   // 
-    int  m_hoverCellIdx = -1;   // һ
-    wxPoint m_hoverCellPos;
-    int HitHoverCell(const wxPoint& raw, int* wireIdx, int* cellIdx, wxPoint* cellPos);
+    int  m_hoverSegWire = -1;   // 
+    int  m_hoverSegIdx = -1;    // һ
+    wxPoint m_hoverSegPos;      // ߶ĵ
+    int HitHoverSegment(const wxPoint& raw, int* wireIdx, int* segIdx, wxPoint* segPos);
 
 	// ߹ҪĽӿ
 public:
@@ -120,6 +263,6 @@ public:
     int HitTestPublic(const wxPoint& pt);
     bool IsClickOnEmptyAreaPublic(const wxPoint& canvasPos);
 
-    std::vector<WireWireAnchor> m_wireWireAnchors;// <->С飨
+    WireJunctionTable m_wireJunctions;// <-> T 
     wxDECLARE_EVENT_TABLE();
 };
\ No newline at end of file
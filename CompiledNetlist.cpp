@@ -0,0 +1,196 @@
+﻿#include "CompiledNetlist.h"
+#include <map>
+
+GateKind GateKindFromName(const wxString& name)
+{
+    static const std::map<wxString, GateKind> table = {
+        { "Buffer Gate",         GateKind::Buffer },
+        { "NOT Gate",            GateKind::Not },
+        { "AND Gate",            GateKind::And },
+        { "AND Gate (Rect)",     GateKind::And },
+        { "NAND Gate",           GateKind::Nand },
+        { "NAND Gate (Rect)",    GateKind::Nand },
+        { "OR Gate",             GateKind::Or },
+        { "OR Gate (Rect)",      GateKind::Or },
+        { "NOR Gate",            GateKind::Nor },
+        { "NOR Gate (Rect)",     GateKind::Nor },
+        { "XOR Gate",            GateKind::Xor },
+        { "XOR Gate (Rect)",     GateKind::Xor },
+        { "XNOR Gate",           GateKind::Xnor },
+        { "XNOR Gate (Rect)",    GateKind::Xnor },
+        { "Odd Parity Gate",     GateKind::OddParity },
+        { "Even Parity Gate",    GateKind::EvenParity },
+        { "Controlled Buffer",   GateKind::ControlledBuffer },
+        { "Controlled Inverter", GateKind::ControlledInverter },
+        { "Wire",                GateKind::Passthrough },
+        { "Tunnel",              GateKind::Passthrough },
+        { "Splitter",            GateKind::Passthrough },
+        { "Pull Resistor",       GateKind::PullResistor },
+        { "Pin (Output)",        GateKind::Source },
+        { "Pin (Input)",         GateKind::Sink },
+        { "Probe",               GateKind::Sink },
+        { "Clock",               GateKind::Clock },
+        { "Constant",            GateKind::Constant },
+        { "Power",               GateKind::Power },
+        { "Ground",              GateKind::Ground },
+    };
+    auto it = table.find(name);
+    return it == table.end() ? GateKind::Unsupported : it->second;
+}
+
+// 元件属性 "Negate 1 (Top)"、"Negate 2" ... 为 true 时对应输入取反；最多 8 个输入
+static uint8_t NegateMaskOf(const CanvasElement& elem)
+{
+    uint8_t mask = 0;
+    for (const auto& prop : elem.GetProperties()) {
+        wxString rest;
+        if (!prop.first.StartsWith("Negate ", &rest)) continue;
+        long n = 0;
+        if (!rest.BeforeFirst(' ').ToLong(&n) || n < 1 || n > 8) continue;
+        if (prop.second == "true" || prop.second == "1") mask |= static_cast<uint8_t>(1u << (n - 1));
+    }
+    return mask;
+}
+
+static bool AcceptsNegate(GateKind kind)
+{
+    switch (kind) {
+    case GateKind::And: case GateKind::Nand:
+    case GateKind::Or:  case GateKind::Nor:
+    case GateKind::Xor: case GateKind::Xnor:
+    case GateKind::OddParity: case GateKind::EvenParity:
+        return true;
+    default:
+        return false;
+    }
+}
+
+void CompiledNetlist::Clear()
+{
+    kind.clear();
+    delay.clear();
+    inStart.clear();
+    inNet.clear();
+    outStart.clear();
+    slotNet.clear();
+    negate.clear();
+    readerStart.clear();
+    readers.clear();
+    driverStart.clear();
+    drivers.clear();
+    wireNet.clear();
+    wireStart.clear();
+    netWires.clear();
+    m_netCount = 0;
+    m_denseNet.clear();
+}
+
+int CompiledNetlist::DenseNet(int netlistNet) const
+{
+    if (netlistNet < 0 || netlistNet >= static_cast<int>(m_denseNet.size())) return -1;
+    return m_denseNet[netlistNet];
+}
+
+void CompiledNetlist::Compile(const std::vector<CanvasElement>& elements, const Netlist& netlist)
+{
+    Clear();
+    const uint32_t gates = static_cast<uint32_t>(elements.size());
+
+    // 1. 门类型按元件编号只解析一次名称
+    std::vector<GateKind> kindById;
+    std::vector<uint8_t> kindKnown;
+    kind.resize(gates);
+    delay.assign(gates, 1);
+    negate.assign(gates, 0);
+    inStart.resize(gates + 1);
+    outStart.resize(gates + 1);
+    uint32_t inputs = 0, outputs = 0;
+    for (uint32_t g = 0; g < gates; ++g) {
+        const ComponentId id = elements[g].GetComponentId();
+        if (id == kInvalidComponent) {
+            kind[g] = GateKindFromName(elements[g].GetName());
+        }
+        else {
+            if (id >= kindById.size()) {
+                kindById.resize(id + 1);
+                kindKnown.resize(id + 1, 0);
+            }
+            if (!kindKnown[id]) {
+                kindById[id] = GateKindFromName(elements[g].GetName());
+                kindKnown[id] = 1;
+            }
+            kind[g] = kindById[id];
+        }
+        // 输入源和时钟的变化立即生效（与 SetSourceValue/Tick 一致），
+        // 否则 Reset 时排下的初值会在之后才生效，盖掉刚设定的值
+        if (kind[g] == GateKind::Source || kind[g] == GateKind::Clock) delay[g] = 0;
+        if (AcceptsNegate(kind[g]) && !elements[g].GetProperties().empty())
+            negate[g] = NegateMaskOf(elements[g]);
+        inStart[g] = inputs;
+        outStart[g] = outputs;
+        inputs += static_cast<uint32_t>(elements[g].GetInputPins().size());
+        outputs += static_cast<uint32_t>(elements[g].GetOutputPins().size());
+    }
+    inStart[gates] = inputs;
+    outStart[gates] = outputs;
+
+    // 2. 网络按首次出现的顺序重新编号；没有网络的引脚各自成网
+    m_denseNet.assign(netlist.GetNetCapacity(), -1);
+    auto dense = [this](int net) -> uint32_t {
+        if (net < 0) return m_netCount++;
+        if (m_denseNet[net] < 0) m_denseNet[net] = static_cast<int>(m_netCount++);
+        return static_cast<uint32_t>(m_denseNet[net]);
+    };
+    inNet.resize(inputs);
+    slotNet.resize(outputs);
+    for (uint32_t g = 0; g < gates; ++g) {
+        for (uint32_t k = 0; k < inStart[g + 1] - inStart[g]; ++k)
+            inNet[inStart[g] + k] = dense(netlist.GetPinNet(g, true, k));
+        for (uint32_t k = 0; k < outStart[g + 1] - outStart[g]; ++k)
+            slotNet[outStart[g] + k] = dense(netlist.GetPinNet(g, false, k));
+    }
+    wireNet.resize(netlist.GetWireCount());
+    for (size_t w = 0; w < wireNet.size(); ++w)
+        wireNet[w] = static_cast<int32_t>(dense(netlist.GetWireNet(w)));
+
+    // 3. 扇出：先计数再填充；同一个门多个输入接同一网络时只记一次
+    const uint32_t nets = m_netCount;
+    std::vector<uint32_t> lastReader(nets, UINT32_MAX);
+    readerStart.assign(nets + 1, 0);
+    driverStart.assign(nets + 1, 0);
+    for (uint32_t g = 0; g < gates; ++g) {
+        for (uint32_t i = inStart[g]; i < inStart[g + 1]; ++i) {
+            const uint32_t n = inNet[i];
+            if (lastReader[n] == g) continue;
+            lastReader[n] = g;
+            ++readerStart[n + 1];
+        }
+    }
+    for (uint32_t s = 0; s < outputs; ++s) ++driverStart[slotNet[s] + 1];
+    for (uint32_t n = 0; n < nets; ++n) {
+        readerStart[n + 1] += readerStart[n];
+        driverStart[n + 1] += driverStart[n];
+    }
+
+    readers.resize(readerStart[nets]);
+    drivers.resize(driverStart[nets]);
+    std::vector<uint32_t> fill(readerStart.begin(), readerStart.end() - 1);
+    std::fill(lastReader.begin(), lastReader.end(), UINT32_MAX);
+    for (uint32_t g = 0; g < gates; ++g) {
+        for (uint32_t i = inStart[g]; i < inStart[g + 1]; ++i) {
+            const uint32_t n = inNet[i];
+            if (lastReader[n] == g) continue;
+            lastReader[n] = g;
+            readers[fill[n]++] = g;
+        }
+    }
+    fill.assign(driverStart.begin(), driverStart.end() - 1);
+    for (uint32_t s = 0; s < outputs; ++s) drivers[fill[slotNet[s]]++] = s;
+
+    wireStart.assign(nets + 1, 0);
+    for (int32_t n : wireNet) ++wireStart[n + 1];
+    for (uint32_t n = 0; n < nets; ++n) wireStart[n + 1] += wireStart[n];
+    netWires.resize(wireStart[nets]);
+    fill.assign(wireStart.begin(), wireStart.end() - 1);
+    for (size_t w = 0; w < wireNet.size(); ++w) netWires[fill[wireNet[w]]++] = static_cast<uint32_t>(w);
+}
@@ -0,0 +1,69 @@
+﻿#pragma once
+#include <wx/wx.h>
+#include <vector>
+#include <cstdint>
+#include "CanvasElement.h"
+#include "Netlist.h"
+
+// 元件的仿真行为，由 CanvasElement::GetName() 映射得到
+// 注意：端口方向以 canvas_elements.json 为准 ——
+// "Pin (Output)" 只有输出端口，是驱动电路的信号源；"Pin (Input)" 只接收信号
+enum class GateKind : uint8_t {
+    Unsupported,        // 尚未建模的元件：输出恒为 Unknown
+    Buffer, Not,
+    And, Nand, Or, Nor, Xor, Xnor,
+    OddParity, EvenParity,
+    ControlledBuffer, ControlledInverter,
+    Passthrough,        // Wire / Tunnel / Splitter：所有输出跟随输入
+    PullResistor,       // 悬空时下拉为 0
+    Source,             // Pin (Output)：可由用户设定的输入源
+    Sink,               // Pin (Input) / Probe：只读
+    Clock, Constant, Power, Ground
+};
+
+GateKind GateKindFromName(const wxString& name);
+
+/*
+ * 编译后的网表：仿真只读这份扁平数组，不再访问 CanvasElement
+ * - 门下标与画布 m_elements 一一对应；网络重新编成 0..N-1 的连续编号
+ * - 扇入、输出槽、网络的读者/驱动者都用 CSR（起始下标数组 + 连续的数据数组）存放，
+ *   第 g 个门的输入网络是 inNet[inStart[g] .. inStart[g+1])，其余同理
+ * - 信号值不在这里，由仿真器按网络编号放在一块连续缓冲里
+ * 求值一个门只读 kind/inStart/outStart 各一项和一段连续的 inNet，通常只碰几条缓存行
+ */
+class CompiledNetlist
+{
+public:
+    void Compile(const std::vector<CanvasElement>& elements, const Netlist& netlist);
+    void Clear();
+
+    uint32_t GateCount() const { return static_cast<uint32_t>(kind.size()); }
+    uint32_t NetCount() const { return m_netCount; }
+    uint32_t SlotCount() const { return static_cast<uint32_t>(slotNet.size()); }
+
+    // 网表的网络编号 -> 连续编号；未知编号返回 -1
+    int DenseNet(int netlistNet) const;
+
+    // 门
+    std::vector<GateKind> kind;
+    std::vector<uint8_t>  delay;       // 传播延迟（时间片）
+    std::vector<uint32_t> inStart;     // GateCount()+1 项
+    std::vector<uint32_t> inNet;       // 输入引脚 -> 网络
+    std::vector<uint32_t> outStart;    // GateCount()+1 项，输出槽即输出引脚
+    std::vector<uint32_t> slotNet;     // 输出槽 -> 网络
+    std::vector<uint8_t>  negate;      // 第 k 位表示第 k 个输入取反（元件属性 "Negate N"，只对与/或/异或类门）
+
+    // 网络
+    std::vector<uint32_t> readerStart; // NetCount()+1 项
+    std::vector<uint32_t> readers;     // 以该网络为输入的门（同一个门只出现一次）
+    std::vector<uint32_t> driverStart; // NetCount()+1 项
+    std::vector<uint32_t> drivers;     // 驱动该网络的输出槽
+
+    std::vector<int32_t>  wireNet;     // 导线 -> 网络（连续编号）；只连着导线的网络也有编号
+    std::vector<uint32_t> wireStart;   // NetCount()+1 项
+    std::vector<uint32_t> netWires;    // 网络上的导线，重画某个网络时使用
+
+private:
+    uint32_t         m_netCount = 0;
+    std::vector<int> m_denseNet;       // 网表编号 -> 连续编号
+};
@@ -0,0 +1,256 @@
+﻿#include "GateKernels.h"
+
+#if defined(_M_X64) || defined(__x86_64__)
+#define GATE_KERNELS_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define GK_TARGET_AVX2
+#else
+#define GK_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#elif defined(_M_ARM64) || defined(__aarch64__)
+#define GATE_KERNELS_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace {
+
+inline uint64_t NegateMask(uint8_t negate, uint32_t k)
+{
+    return 0 - static_cast<uint64_t>((negate >> k) & 1);
+}
+
+template <BitOp OP> inline uint64_t Combine(uint64_t a, uint64_t b)
+{
+    if (OP == BitOp::And) return a & b;
+    if (OP == BitOp::Or) return a | b;
+    if (OP == BitOp::Xor) return a ^ b;
+    return a;
+}
+
+// 标量：从第 begin 个门开始处理到组末尾（也用来收尾向量版本剩下的门）
+template <BitOp OP>
+void RunScalarOp(uint64_t* words, size_t lanes, const GateGroup& g, uint32_t begin)
+{
+    const uint64_t flip = g.invert ? ~0ull : 0;
+    for (uint32_t i = begin; i < g.count; ++i) {
+        uint64_t* out = words + static_cast<size_t>(g.firstOut + i) * lanes;
+        const uint8_t neg = g.negate ? g.negate[i] : 0;
+        for (size_t l = 0; l < lanes; ++l) {
+            uint64_t v = words[static_cast<size_t>(g.inputs[i]) * lanes + l] ^ NegateMask(neg, 0);
+            for (uint32_t k = 1; k < g.arity; ++k)
+                v = Combine<OP>(v, words[static_cast<size_t>(g.inputs[k * g.count + i]) * lanes + l] ^ NegateMask(neg, k));
+            out[l] = v ^ flip;
+        }
+    }
+}
+
+void RunScalarFrom(uint64_t* words, size_t lanes, const GateGroup& g, uint32_t begin)
+{
+    switch (g.op) {
+    case BitOp::And:  RunScalarOp<BitOp::And>(words, lanes, g, begin); break;
+    case BitOp::Or:   RunScalarOp<BitOp::Or>(words, lanes, g, begin); break;
+    case BitOp::Xor:  RunScalarOp<BitOp::Xor>(words, lanes, g, begin); break;
+    case BitOp::Copy: RunScalarOp<BitOp::Copy>(words, lanes, g, begin); break;
+    }
+}
+
+void RunScalar(uint64_t* words, size_t lanes, const GateGroup& g)
+{
+    RunScalarFrom(words, lanes, g, 0);
+}
+
+#if GATE_KERNELS_X86
+
+template <BitOp OP> GK_TARGET_AVX2 inline __m256i Combine256(__m256i a, __m256i b)
+{
+    if (OP == BitOp::And) return _mm256_and_si256(a, b);
+    if (OP == BitOp::Or) return _mm256_or_si256(a, b);
+    if (OP == BitOp::Xor) return _mm256_xor_si256(a, b);
+    return a;
+}
+
+GK_TARGET_AVX2 inline __m256i NegateMask256(const uint8_t* neg, uint32_t k)
+{
+    return _mm256_set_epi64x(
+        static_cast<long long>(NegateMask(neg[3], k)), static_cast<long long>(NegateMask(neg[2], k)),
+        static_cast<long long>(NegateMask(neg[1], k)), static_cast<long long>(NegateMask(neg[0], k)));
+}
+
+// 每个门占 lanes 个字（4 的倍数）：逐门处理，一条指令覆盖 256 组输入
+template <BitOp OP>
+GK_TARGET_AVX2 void RunAvx2Lanes(uint64_t* words, size_t lanes, const GateGroup& g)
+{
+    const __m256i flip = g.invert ? _mm256_set1_epi64x(-1) : _mm256_setzero_si256();
+    for (uint32_t i = 0; i < g.count; ++i) {
+        __m256i* out = reinterpret_cast<__m256i*>(words + static_cast<size_t>(g.firstOut + i) * lanes);
+        const uint8_t neg = g.negate ? g.negate[i] : 0;
+        const __m256i* in0 = reinterpret_cast<const __m256i*>(words + static_cast<size_t>(g.inputs[i]) * lanes);
+        for (size_t l = 0; l < lanes / 4; ++l) {
+            __m256i v = _mm256_xor_si256(_mm256_loadu_si256(in0 + l),
+                _mm256_set1_epi64x(static_cast<long long>(NegateMask(neg, 0))));
+            for (uint32_t k = 1; k < g.arity; ++k) {
+                const __m256i* in = reinterpret_cast<const __m256i*>(words + static_cast<size_t>(g.inputs[k * g.count + i]) * lanes);
+                const __m256i x = _mm256_xor_si256(_mm256_loadu_si256(in + l),
+                    _mm256_set1_epi64x(static_cast<long long>(NegateMask(neg, k))));
+                v = Combine256<OP>(v, x);
+            }
+            _mm256_storeu_si256(out + l, _mm256_xor_si256(v, flip));
+        }
+    }
+}
+
+// 每个门只有一个字：用 gather 一次取 4 个门的输入，结果连续写回
+template <BitOp OP>
+GK_TARGET_AVX2 void RunAvx2Gather(uint64_t* words, const GateGroup& g)
+{
+    const __m256i flip = g.invert ? _mm256_set1_epi64x(-1) : _mm256_setzero_si256();
+    const long long* base = reinterpret_cast<const long long*>(words);
+    uint32_t i = 0;
+    for (; i + 4 <= g.count; i += 4) {
+        __m256i v = _mm256_i32gather_epi64(base, _mm_loadu_si128(reinterpret_cast<const __m128i*>(g.inputs + i)), 8);
+        if (g.negate) v = _mm256_xor_si256(v, NegateMask256(g.negate + i, 0));
+        for (uint32_t k = 1; k < g.arity; ++k) {
+            __m256i x = _mm256_i32gather_epi64(base,
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(g.inputs + k * g.count + i)), 8);
+            if (g.negate) x = _mm256_xor_si256(x, NegateMask256(g.negate + i, k));
+            v = Combine256<OP>(v, x);
+        }
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(words + g.firstOut + i), _mm256_xor_si256(v, flip));
+    }
+    RunScalarFrom(words, 1, g, i);
+}
+
+template <BitOp OP>
+void RunAvx2Op(uint64_t* words, size_t lanes, const GateGroup& g)
+{
+    if (lanes % 4 == 0) RunAvx2Lanes<OP>(words, lanes, g);
+    else if (lanes == 1) RunAvx2Gather<OP>(words, g);
+    else RunScalarOp<OP>(words, lanes, g, 0);
+}
+
+void RunAvx2(uint64_t* words, size_t lanes, const GateGroup& g)
+{
+    switch (g.op) {
+    case BitOp::And:  RunAvx2Op<BitOp::And>(words, lanes, g); break;
+    case BitOp::Or:   RunAvx2Op<BitOp::Or>(words, lanes, g); break;
+    case BitOp::Xor:  RunAvx2Op<BitOp::Xor>(words, lanes, g); break;
+    case BitOp::Copy: RunAvx2Op<BitOp::Copy>(words, lanes, g); break;
+    }
+}
+
+bool CpuHasAvx2()
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    int r[4];
+    __cpuid(r, 0);
+    if (r[0] < 7) return false;
+    __cpuid(r, 1);
+    const bool osxsave = (r[2] & (1 << 27)) != 0, avx = (r[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx) return false;
+    if ((_xgetbv(0) & 6) != 6) return false;   // 操作系统保存 YMM 寄存器
+    __cpuidex(r, 7, 0);
+    return (r[1] & (1 << 5)) != 0;
+#else
+    return __builtin_cpu_supports("avx2") != 0;
+#endif
+}
+
+#endif // GATE_KERNELS_X86
+
+#if GATE_KERNELS_NEON
+
+template <BitOp OP> inline uint64x2_t Combine128(uint64x2_t a, uint64x2_t b)
+{
+    if (OP == BitOp::And) return vandq_u64(a, b);
+    if (OP == BitOp::Or) return vorrq_u64(a, b);
+    if (OP == BitOp::Xor) return veorq_u64(a, b);
+    return a;
+}
+
+// 每个门占 lanes 个字（2 的倍数）：逐门处理，一条指令覆盖 128 组输入
+template <BitOp OP>
+void RunNeonOp(uint64_t* words, size_t lanes, const GateGroup& g)
+{
+    if (lanes % 2 != 0) {
+        RunScalarOp<OP>(words, lanes, g, 0);
+        return;
+    }
+    const uint64x2_t flip = vdupq_n_u64(g.invert ? ~0ull : 0);
+    for (uint32_t i = 0; i < g.count; ++i) {
+        uint64_t* out = words + static_cast<size_t>(g.firstOut + i) * lanes;
+        const uint8_t neg = g.negate ? g.negate[i] : 0;
+        const uint64_t* in0 = words + static_cast<size_t>(g.inputs[i]) * lanes;
+        for (size_t l = 0; l < lanes; l += 2) {
+            uint64x2_t v = veorq_u64(vld1q_u64(in0 + l), vdupq_n_u64(NegateMask(neg, 0)));
+            for (uint32_t k = 1; k < g.arity; ++k) {
+                const uint64_t* in = words + static_cast<size_t>(g.inputs[k * g.count + i]) * lanes;
+                v = Combine128<OP>(v, veorq_u64(vld1q_u64(in + l), vdupq_n_u64(NegateMask(neg, k))));
+            }
+            vst1q_u64(out + l, veorq_u64(v, flip));
+        }
+    }
+}
+
+void RunNeon(uint64_t* words, size_t lanes, const GateGroup& g)
+{
+    switch (g.op) {
+    case BitOp::And:  RunNeonOp<BitOp::And>(words, lanes, g); break;
+    case BitOp::Or:   RunNeonOp<BitOp::Or>(words, lanes, g); break;
+    case BitOp::Xor:  RunNeonOp<BitOp::Xor>(words, lanes, g); break;
+    case BitOp::Copy: RunNeonOp<BitOp::Copy>(words, lanes, g); break;
+    }
+}
+
+#endif // GATE_KERNELS_NEON
+
+} // namespace
+
+bool IsKernelIsaSupported(KernelIsa isa)
+{
+    switch (isa) {
+    case KernelIsa::Scalar: return true;
+#if GATE_KERNELS_X86
+    case KernelIsa::Avx2: {
+        static const bool avx2 = CpuHasAvx2();
+        return avx2;
+    }
+#endif
+#if GATE_KERNELS_NEON
+    case KernelIsa::Neon: return true;   // AArch64 必定带 NEON
+#endif
+    default: return false;
+    }
+}
+
+KernelIsa DetectKernelIsa()
+{
+    static const KernelIsa isa =
+        IsKernelIsaSupported(KernelIsa::Avx2) ? KernelIsa::Avx2 :
+        IsKernelIsaSupported(KernelIsa::Neon) ? KernelIsa::Neon : KernelIsa::Scalar;
+    return isa;
+}
+
+GateKernel GetGateKernel(KernelIsa isa)
+{
+    if (!IsKernelIsaSupported(isa)) return &RunScalar;
+    switch (isa) {
+#if GATE_KERNELS_X86
+    case KernelIsa::Avx2: return &RunAvx2;
+#endif
+#if GATE_KERNELS_NEON
+    case KernelIsa::Neon: return &RunNeon;
+#endif
+    default: return &RunScalar;
+    }
+}
+
+const char* KernelIsaName(KernelIsa isa)
+{
+    switch (isa) {
+    case KernelIsa::Avx2: return "AVX2";
+    case KernelIsa::Neon: return "NEON";
+    default:              return "Scalar";
+    }
+}
@@ -0,0 +1,40 @@
+﻿#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// 位并行求值的基本运算；NAND/NOR/XNOR/NOT 为对应运算加输出取反
+enum class BitOp : uint8_t { And, Or, Xor, Copy };
+
+/*
+ * 一组同类型、同输入数、同层的门：组内的门互不依赖，可以一起求值
+ * - 第 i 个门的第 k 个输入所在的字为 inputs[k * count + i]（按输入序号分块）
+ * - 结果写到 firstOut 起连续的 count 个字，向量化时可以整块写回
+ * - negate[i] 的第 k 位表示第 i 个门的第 k 个输入取反（Negate N），为 nullptr 时都不取反
+ * 字 w 占 words[w*lanes, (w+1)*lanes)
+ */
+struct GateGroup
+{
+    BitOp    op = BitOp::Copy;
+    bool     invert = false;
+    uint32_t arity = 0;
+    uint32_t count = 0;
+    uint32_t firstOut = 0;
+    const uint32_t* inputs = nullptr;
+    const uint8_t*  negate = nullptr;
+};
+
+enum class KernelIsa : uint8_t { Scalar, Avx2, Neon };
+
+using GateKernel = void (*)(uint64_t* words, size_t lanes, const GateGroup& group);
+
+/*
+ * 门求值内核：标量版本总是可用；x86-64 上运行时检测到 AVX2 时使用 AVX2，
+ * AArch64 上使用 NEON
+ * - lanes 为向量宽度的整数倍时，每个门的多个字一次处理
+ * - lanes == 1 时 AVX2 用 gather 一次取 4 个门的输入，同时算 4 个门
+ * 其余情况退回标量循环
+ */
+KernelIsa   DetectKernelIsa();                  // 结果缓存，只检测一次
+bool        IsKernelIsaSupported(KernelIsa isa);
+GateKernel  GetGateKernel(KernelIsa isa);       // 不支持时返回标量内核
+const char* KernelIsaName(KernelIsa isa);
@@ -3,9 +3,11 @@
 #include "CanvasPanel.h"
 #include "PropertyPanel.h"
 #include <wx/msgdlg.h>
+#include <wx/progdlg.h>
 #include "ToolboxPanel.h"   // Ĳ
 #include <wx/aui/aui.h>
 #include "CanvasModel.h"
+#include "PatternSimulator.h"
 #include "my_log.h"
 #include <wx/filename.h> 
 #include <wx/sstream.h>
@@ -241,6 +243,13 @@ wxString MainFrame::GenerateFileContent()
         element->AddAttribute("y", wxString::Format("%d", elem.GetPos().y));  // Y
         // ƳйrotationĴ
         // element->AddAttribute("rotation", wxString::Format("%d", elem.GetRotation()));
+        // Ԫԣ "Negate N" Logisim дΪ <a name=".." val=".."/>
+        for (const auto& prop : elem.GetProperties()) {
+            wxXmlNode* attr = new wxXmlNode(wxXML_ELEMENT_NODE, "a");
+            attr->AddAttribute("name", prop.first);
+            attr->AddAttribute("val", prop.second);
+            element->AddChild(attr);
+        }
         circuit->AddChild(element);
     }
 
@@ -356,7 +365,15 @@ void MainFrame::DoFileOpen(const wxString& path)
             // ƳйrotationĶȡ
             // int rotation = wxAtoi(child->GetAttribute("rotation", "0"));
 
-            m_canvas->PlaceElement(name, wxPoint(x, y));
+            // ģ帴Ԫļﱣ
+            ComponentId id = FindComponentId(name);
+            if (id < g_elements.size()) {
+                CanvasElement elem = g_elements[id];
+                elem.SetPos(wxPoint(x, y));
+                for (wxXmlNode* attr = child->GetChildren(); attr; attr = attr->GetNext())
+                    if (attr->GetName() == "a") elem.SetProperty(attr->GetAttribute("name"), attr->GetAttribute("val"));
+                m_canvas->AddElement(elem);
+            }
             // ͬʱƳתǶȵ߼еĻ
         }
 
@@ -393,13 +410,15 @@ void MainFrame::DoFileOpen(const wxString& path)
             // Wireӵ
             Wire wire;
             wire.pts = pts;  // ֱӸֵWireptsԱ
-            wire.GenerateCells();  // 㣨ʾһԣ
             m_canvas->AddWire(wire);
         }
         
         child = child->GetNext();
     }
 
+    // ļﲻ浼֮ӣλʶ
+    m_canvas->DetectTJunctions();
+
     // ״̬
     m_currentFilePath = filePath;
     m_isModified = false;
@@ -496,19 +515,209 @@ void MainFrame::DoProjectViewToolbox() { wxMessageBox("Project->View Toolbox");
 void MainFrame::DoProjectViewSimTree() { wxMessageBox("Project->View Simulation Tree"); }
 void MainFrame::DoProjectEditLayout() { wxMessageBox("Project->Edit Circuit Layout"); }
 void MainFrame::DoProjectEditAppearance() { wxMessageBox("Project->Edit Circuit Appearance"); }
-void MainFrame::DoProjectAnalyzeCircuit() { wxMessageBox("Project->Analyze Circuit"); }
-void MainFrame::DoProjectGetStats() { wxMessageBox("Project->Get Circuit Statistics"); }
+// öķģṹڽеķ
+void MainFrame::DoProjectAnalyzeCircuit()
+{
+    Simulator sim;
+    sim.Build(m_canvas->GetElements(), m_canvas->GetNetlist());
+    wxString verdict = sim.GetLoopCount() == 0
+        ? wxString("޷ϵ·òλʽ")
+        : wxString("λʱڰ¼ֵ");
+
+    // ϵ·λɨһ룺벻ʱ٣ȡ
+    PatternSimulator batch;
+    if (sim.GetLoopCount() == 0) {
+        if (batch.Build(sim)) {
+            batch.SetLanes(4);
+            const bool exhaustive = batch.GetInputCount() <= 20;
+            const uint64_t total = exhaustive ? (1ull << batch.GetInputCount()) : (1ull << 20);
+
+            // ·Ҫü룺 300 ms ŵȿ֮ÿ 100 ms ˢһΣȡ
+            std::unique_ptr<wxProgressDialog> progress;
+            wxStopWatch watch;
+            long lastUpdate = 0;
+            bool cancelled = false;
+            const size_t outputs = batch.GetOutputCount();
+            std::vector<uint64_t> seenOne(outputs, 0), seenZero(outputs, 0);
+            auto collect = [&](const PatternSimulator& ps, uint64_t first) {
+                for (size_t o = 0; o < outputs; ++o) {
+                    const uint64_t* w = ps.OutputWords(o);
+                    for (size_t l = 0; l < ps.GetLanes(); ++l) {
+                        seenOne[o] |= w[l];
+                        seenZero[o] |= ~w[l];
+                    }
+                }
+                const long now = watch.Time();
+                if (now < 300 || now - lastUpdate < 100) return true;
+                lastUpdate = now;
+                if (!progress) {
+                    progress = std::make_unique<wxProgressDialog>("·",
+                        exhaustive ? "..." : "ڷ...", 1000, this,
+                        wxPD_APP_MODAL | wxPD_CAN_ABORT | wxPD_ELAPSED_TIME | wxPD_REMAINING_TIME);
+                }
+                if (!progress->Update(static_cast<int>(first * 1000 / total))) {
+                    cancelled = true;
+                    return false;
+                }
+                return true;
+            };
+            const uint64_t patterns = exhaustive ? batch.RunExhaustive(collect) : batch.RunRandom(total, 1, collect);
+            progress.reset();
+            size_t constant = 0;
+            for (size_t o = 0; o < outputs; ++o)
+                if (!seenOne[o] || !seenZero[o]) ++constant;
+            verdict += wxString::Format("\n%s %llu %s %zu  %zu ʱ %ld ms%s\n%s: %zu ",
+                exhaustive ? "" : "", static_cast<unsigned long long>(patterns), cancelled ? "ȡ" : "",
+                batch.GetInputCount(), outputs, watch.Time(), KernelIsaName(batch.GetKernelIsa()),
+                cancelled ? "к㶨" : "㶨", constant);
+        }
+        else {
+            verdict += "\n治ã" + batch.GetError();
+        }
+    }
+
+    wxMessageBox(wxString::Format("Ԫ: %zu\n: %zu\n߼: %zu\n: %zu 漰Ԫ %zu \n\n%s",
+        sim.GetComponentCount(),
+        sim.GetNetCount(),
+        sim.GetLevelCount(),
+        sim.GetLoopCount(),
+        sim.GetLoopGateCount(),
+        verdict), "·");
+}
+void MainFrame::DoProjectGetStats()
+{
+    const Netlist& netlist = m_canvas->GetNetlist();
+    wxMessageBox(wxString::Format("Ԫ: %zu\n: %zu\nT : %zu\n: %d",
+        m_canvas->GetElements().size(),
+        m_canvas->GetWires().size(),
+        m_canvas->m_wireJunctions.size(),
+        netlist.GetNetCount()), "·ͳ");
+}
 void MainFrame::DoProjectOptions() { wxMessageBox("Project->Options"); }
 
 void MainFrame::DoSimSetEnabled(bool on)
 {
-    wxMessageBox(wxString::Format("Simulation %s", on ? "enabled" : "disabled"));
+    m_simEnabled = on;
+    if (on) {
+        RebuildSimulation();
+    }
+    else {
+        m_simulator.Clear();
+        m_canvas->SetSimulator(nullptr);
+        SetStatusText("ѹر");
+    }
 }
-void MainFrame::DoSimReset() { wxMessageBox("Simulation reset"); }
-void MainFrame::DoSimStep() { wxMessageBox("Simulation step"); }
+
+void MainFrame::DoSimReset()
+{
+    RebuildSimulation();
+}
+
+// ֻһʱƬе¼λģʽ°ȫԪֵһ
+void MainFrame::DoSimStep()
+{
+    if (!m_simEnabled) {
+        SetStatusText("δ");
+        return;
+    }
+    EnsureSimulation();
+    m_simulator.Step();
+    m_canvas->RefreshSimWires();
+    m_simulator.ClearValueChanges();
+    UpdateSimStatus();
+}
+
 void MainFrame::DoSimGoOut() { wxMessageBox("Go Out To State"); }
 void MainFrame::DoSimGoIn() { wxMessageBox("Go In To State"); }
-void MainFrame::DoSimTickOnce() { wxMessageBox("Tick Once"); }
+
+void MainFrame::DoSimTickOnce()
+{
+    if (!m_simEnabled) {
+        SetStatusText("δ");
+        return;
+    }
+    EnsureSimulation();
+    m_simulator.Tick();
+    const bool stable = m_simulator.Propagate();
+    m_canvas->RefreshSimWires();
+    m_simulator.ClearValueChanges();
+    if (!stable) {
+        SetStatusText("δ·ܴ");
+        return;
+    }
+    UpdateSimStatus();
+}
+
+bool MainFrame::DoSimToggleSource(size_t elemIdx)
+{
+    if (!m_simEnabled) return false;
+    EnsureSimulation();
+    const SimValue cur = m_simulator.GetPinValue(elemIdx, false, 0);
+    if (!m_simulator.SetSourceValue(elemIdx, cur == SimValue::One ? SimValue::Zero : SimValue::One))
+        return false;   // 
+    const bool stable = m_simulator.Propagate();
+    m_canvas->RefreshSimWires();
+    m_simulator.ClearValueChanges();
+    if (!stable) {
+        SetStatusText("δ·ܴ");
+        return true;
+    }
+    UpdateSimStatus();
+    return true;
+}
+
+void MainFrame::EnsureSimulation()
+{
+    const Netlist& netlist = m_canvas->GetNetlist();
+    if (m_simulator.IsBuilt() && m_simRevision == netlist.GetRevision()) return;
+
+    // ûɾԪʱֻˣ״ֵֻ̬ڱ仯ϵ
+    if (m_simulator.IsBuilt() && m_simLayout == netlist.GetLayoutRevision() &&
+        m_simulator.Update(m_canvas->GetElements(), netlist, netlist.GetChangedNets())) {
+        m_simRevision = netlist.GetRevision();
+        m_canvas->m_netlist.ClearChangedNets();
+        return;
+    }
+    RebuildSimulation();
+}
+
+// رʱҲҵϣȴʱٽ
+void MainFrame::RebuildSimulation()
+{
+    if (!m_simEnabled) return;
+    m_simulator.Build(m_canvas->GetElements(), m_canvas->GetNetlist());
+    m_simRevision = m_canvas->GetNetlist().GetRevision();
+    m_simLayout = m_canvas->GetNetlist().GetLayoutRevision();
+    m_canvas->m_netlist.ClearChangedNets();
+    m_simulator.Reset();
+    if (!m_simulator.Propagate()) {
+        SetStatusText("δ·ܴ");
+    }
+    else {
+        UpdateSimStatus();
+    }
+    m_canvas->SetSimulator(&m_simulator);   // ػ
+    m_simulator.ClearValueChanges();
+}
+
+void MainFrame::UpdateSimStatus()
+{
+    if (m_simulator.GetMode() == SimMode::Levelized) {
+        SetStatusText(wxString::Format("(λ):  %llu   ۼֵ %zu  (Ԫ %zu, %zu ,  %zu)",
+            static_cast<unsigned long long>(m_simulator.GetTime()),
+            m_simulator.GetEvaluationCount(),
+            m_simulator.GetComponentCount(),
+            m_simulator.GetLevelCount(),
+            m_simulator.GetLoopCount()));
+        return;
+    }
+    SetStatusText(wxString::Format(": t=%llu  ¼ %zu  ۼֵ %zu  (Ԫ %zu,  %zu)",
+        static_cast<unsigned long long>(m_simulator.GetTime()),
+        m_simulator.GetPendingEvents(),
+        m_simulator.GetEvaluationCount(),
+        m_simulator.GetComponentCount(),
+        m_simulator.GetNetCount()));
+}
 void MainFrame::DoSimTicksEnabled(bool on)
 {
     wxMessageBox(wxString::Format("Ticks %s", on ? "enabled" : "disabled"));
@@ -519,9 +728,15 @@ void MainFrame::DoSimSetTickFreq(int hz)
 }
 void MainFrame::DoSimLogging() { wxMessageBox("Logging dialog"); }
 
+// ¼λֵ֮ллؽ
 void MainFrame::DoWindowCombinationalAnalysis()
 {
-    wxMessageBox("Window->Combinational Analysis");
+    const bool levelized = m_simulator.GetMode() != SimMode::Levelized;
+    m_simulator.SetMode(levelized ? SimMode::Levelized : SimMode::EventDriven);
+    if (m_simEnabled)
+        RebuildSimulation();
+    else
+        SetStatusText(levelized ? "淽ʽ: λδã" : "淽ʽ: ¼δã");
 }
 void MainFrame::DoWindowPreferences()
 {
@@ -84,6 +84,8 @@ public:
     void DoSimTicksEnabled(bool on);
     void DoSimSetTickFreq(int hz);
     void DoSimLogging();
+    // ѡ񹤾µԪʱתǷ
+    bool DoSimToggleSource(size_t elemIdx);
 
     /* Window ˵ҵӿ */
     void DoWindowCombinationalAnalysis();
@@ -112,6 +114,15 @@ private:
     PropertyPanel* m_propPanel = nullptr;
     CanvasPanel* m_canvas;
 
+    // 
+    Simulator m_simulator;
+    uint64_t m_simRevision = 0;    // ģͶӦ汾
+    uint64_t m_simLayout = 0;      // ģͶӦԪ±겼֣Netlist::GetLayoutRevision
+    bool m_simEnabled = false;     // Ӧ Simulate -> Simulation Enabled仯Զȶ
+    void EnsureSimulation();       // ޸ʱ£ɾԪʱؽ
+    void RebuildSimulation();
+    void UpdateSimStatus();
+
     void UpdateCursor();        //  m_pendingTool ʮ/
 
     void OnToolboxElement(wxCommandEvent& evt);
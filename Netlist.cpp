@@ -0,0 +1,625 @@
+﻿#include "Netlist.h"
+#include "my_log.h"
+#include <algorithm>
+#include <utility>
+
+//================= 并查集 =================
+void DisjointSet::Reset(size_t n)
+{
+    m_parent.resize(n);
+    m_size.assign(n, 1);
+    for (size_t i = 0; i < n; ++i) m_parent[i] = static_cast<int>(i);
+}
+
+int DisjointSet::Add()
+{
+    m_parent.push_back(static_cast<int>(m_parent.size()));
+    m_size.push_back(1);
+    return m_parent.back();
+}
+
+int DisjointSet::Find(int x)
+{
+    int root = x;
+    while (m_parent[root] != root) root = m_parent[root];
+    // 路径压缩：沿途节点直接指向根
+    while (m_parent[x] != root) {
+        int next = m_parent[x];
+        m_parent[x] = root;
+        x = next;
+    }
+    return root;
+}
+
+bool DisjointSet::Unite(int a, int b)
+{
+    a = Find(a);
+    b = Find(b);
+    if (a == b) return false;
+    if (m_size[a] < m_size[b]) std::swap(a, b);
+    m_parent[b] = a;
+    m_size[a] += m_size[b];
+    return true;
+}
+
+//================= 网表 =================
+namespace {
+
+inline uint64_t PointKey(const wxPoint& p)
+{
+    return (static_cast<uint64_t>(static_cast<uint32_t>(p.x)) << 32) | static_cast<uint32_t>(p.y);
+}
+
+// 点是否在线段上（含两端）
+bool OnSegment(const wxPoint& p, const wxPoint& a, const wxPoint& b)
+{
+    if (a.y == b.y && p.y == a.y)
+        return p.x >= std::min(a.x, b.x) && p.x <= std::max(a.x, b.x);
+    if (a.x == b.x && p.x == a.x)
+        return p.y >= std::min(a.y, b.y) && p.y <= std::max(a.y, b.y);
+    return false;
+}
+
+// 点是否为导线的首尾端点（端点重合已由坐标哈希处理，不算 T 型连接）
+inline bool IsWireEnd(const wxPoint& p, const std::vector<ControlPoint>& pts)
+{
+    return p == pts.front().pos || p == pts.back().pos;
+}
+
+} // namespace
+
+void Netlist::Clear()
+{
+    m_items.clear();
+    m_freeItems.clear();
+    m_points.clear();
+    m_freePoints.clear();
+    m_pointIndex.clear();
+    m_nets.clear();
+    m_freeNets.clear();
+    m_liveNets = 0;
+    m_wireItem.clear();
+    m_elemPins.clear();
+    m_changed.clear();
+    m_changedFlag.clear();
+    m_visit.clear();
+    m_visitStamp = 0;
+    ++m_revision;
+    ++m_layoutRevision;
+}
+
+//---------------- 结点 / 坐标点 / 网络的分配 ----------------
+int Netlist::NewItem()
+{
+    int id;
+    if (!m_freeItems.empty()) {
+        id = m_freeItems.back();
+        m_freeItems.pop_back();
+        m_items[id] = Item();
+    }
+    else {
+        id = static_cast<int>(m_items.size());
+        m_items.emplace_back();
+        m_visit.push_back(0);
+    }
+    return id;
+}
+
+void Netlist::FreeItem(int item)
+{
+    m_items[item] = Item();
+    m_freeItems.push_back(item);
+}
+
+int Netlist::NewNet()
+{
+    int id;
+    if (!m_freeNets.empty()) {
+        id = m_freeNets.back();
+        m_freeNets.pop_back();
+    }
+    else {
+        id = static_cast<int>(m_nets.size());
+        m_nets.emplace_back();
+    }
+    ++m_liveNets;
+    return id;
+}
+
+int Netlist::PointOf(const wxPoint& p)
+{
+    auto r = m_pointIndex.emplace(PointKey(p), 0);
+    if (!r.second) return r.first->second;
+
+    int id;
+    if (!m_freePoints.empty()) {
+        id = m_freePoints.back();
+        m_freePoints.pop_back();
+    }
+    else {
+        id = static_cast<int>(m_points.size());
+        m_points.emplace_back();
+    }
+    m_points[id].key = r.first->first;
+    r.first->second = id;
+    return id;
+}
+
+void Netlist::MarkChanged(int net)
+{
+    if (net < 0) return;
+    if (m_changedFlag.size() < m_nets.size()) m_changedFlag.resize(m_nets.size(), 0);
+    if (m_changedFlag[net]) return;
+    m_changedFlag[net] = 1;
+    m_changed.push_back(net);
+}
+
+void Netlist::ClearChangedNets()
+{
+    for (int n : m_changed) m_changedFlag[n] = 0;
+    m_changed.clear();
+}
+
+//---------------- 网络成员维护 ----------------
+void Netlist::JoinNet(int item, int net)
+{
+    Item& it = m_items[item];
+    it.net = net;
+    it.netSlot = static_cast<uint32_t>(m_nets[net].items.size());
+    m_nets[net].items.push_back(item);
+}
+
+void Netlist::LeaveNet(int item)
+{
+    Item& it = m_items[item];
+    auto& members = m_nets[it.net].items;
+    int moved = members.back();
+    members[it.netSlot] = moved;
+    m_items[moved].netSlot = it.netSlot;
+    members.pop_back();
+    it.net = -1;
+}
+
+void Netlist::MergeNets(int from, int into)
+{
+    // 调用方保证 from 是较小的一方
+    for (int item : m_nets[from].items) {
+        m_items[item].net = into;
+        m_items[item].netSlot = static_cast<uint32_t>(m_nets[into].items.size());
+        m_nets[into].items.push_back(item);
+    }
+    m_nets[from].items.clear();
+    m_freeNets.push_back(from);
+    --m_liveNets;
+    MarkChanged(from);
+    MarkChanged(into);
+}
+
+template <class Fn>
+void Netlist::ForEachNeighbour(int item, Fn fn) const
+{
+    const Item& it = m_items[item];
+    for (int p : it.points)
+        for (int other : m_points[p].items)
+            if (other != item) fn(other);
+    for (int other : it.links) fn(other);
+}
+
+//---------------- 挂接 / 摘下 ----------------
+void Netlist::Attach(int item)
+{
+    // 相邻结点所在的网络；同一坐标点上的结点必然同属一个网络，取一个即可
+    std::vector<int> nets;
+    for (int p : m_items[item].points) {
+        auto& at = m_points[p].items;
+        if (!at.empty()) nets.push_back(m_items[at.front()].net);
+        at.push_back(item);
+    }
+    for (int other : m_items[item].links)
+        nets.push_back(m_items[other].net);
+
+    std::sort(nets.begin(), nets.end());
+    nets.erase(std::unique(nets.begin(), nets.end()), nets.end());
+
+    int target;
+    if (nets.empty()) {
+        target = NewNet();
+    }
+    else {
+        target = nets.front();
+        for (int n : nets)
+            if (m_nets[n].items.size() > m_nets[target].items.size()) target = n;
+        for (int n : nets)
+            if (n != target) MergeNets(n, target);
+    }
+    JoinNet(item, target);
+    MarkChanged(target);
+}
+
+void Netlist::Detach(int item)
+{
+    Item& it = m_items[item];
+    int net = it.net;
+
+    // 被摘下结点的邻居：每个坐标点留一个代表即可（同一点上的结点仍互相连通）
+    std::vector<int> neighbours;
+    for (int p : it.points) {
+        auto& at = m_points[p].items;
+        at.erase(std::find(at.begin(), at.end(), item));
+        if (!at.empty()) {
+            neighbours.push_back(at.front());
+        }
+        else {
+            m_pointIndex.erase(m_points[p].key);
+            m_freePoints.push_back(p);
+        }
+    }
+    for (int other : it.links) {
+        auto& back = m_items[other].links;
+        back.erase(std::find(back.begin(), back.end(), item));
+        neighbours.push_back(other);
+    }
+    it.points.clear();
+    it.links.clear();
+
+    LeaveNet(item);
+    MarkChanged(net);
+    if (m_nets[net].items.empty()) {
+        m_freeNets.push_back(net);
+        --m_liveNets;
+        return;
+    }
+    SplitAfterRemoval(net, neighbours);
+}
+
+void Netlist::SplitAfterRemoval(int net, std::vector<int>& neighbours)
+{
+    std::sort(neighbours.begin(), neighbours.end());
+    neighbours.erase(std::unique(neighbours.begin(), neighbours.end()), neighbours.end());
+    if (neighbours.size() <= 1) return;
+
+    // 依次从尚未到达的邻居出发 BFS：
+    // - 途中到达了全部剩余邻居 → 剩下的部分仍连通，保留原网络编号，立即停止
+    // - BFS 走完仍有邻居未到达 → 这是一个完整的断开分量，移入新网络
+    const uint32_t stamp = ++m_visitStamp;
+    size_t remaining = neighbours.size();
+    std::vector<int> component;
+    for (int start : neighbours) {
+        if (m_visit[start] == stamp) continue;
+
+        component.clear();
+        m_queue.clear();
+        m_queue.push_back(start);
+        m_visit[start] = stamp;
+        size_t reached = 0;
+        bool connected = false;
+        for (size_t head = 0; head < m_queue.size(); ++head) {
+            int cur = m_queue[head];
+            component.push_back(cur);
+            if (std::binary_search(neighbours.begin(), neighbours.end(), cur) && ++reached == remaining) {
+                connected = true;
+                break;
+            }
+            ForEachNeighbour(cur, [&](int other) {
+                if (m_visit[other] != stamp) {
+                    m_visit[other] = stamp;
+                    m_queue.push_back(other);
+                }
+                });
+        }
+        if (connected) return;
+
+        int split = NewNet();
+        for (int member : component) {
+            LeaveNet(member);
+            JoinNet(member, split);
+        }
+        MarkChanged(split);
+        remaining -= reached;
+    }
+}
+
+//---------------- 结点构造 ----------------
+void Netlist::SetWirePoints(int item, const Wire& wire)
+{
+    // 只有首尾端点参与坐标合并；中间折点与别的导线重合不算连接
+    // （自动布线的折点可能恰好落在同一位置），导线间的连接只靠端点和 T 型连接
+    std::vector<int> points;
+    if (!wire.pts.empty()) {
+        points.push_back(PointOf(wire.pts.front().pos));
+        points.push_back(PointOf(wire.pts.back().pos));
+    }
+
+    Item& it = m_items[item];
+    it.front = points.empty() ? -1 : points.front();
+    it.back = points.empty() ? -1 : points.back();
+    it.last = wire.pts.empty() ? 0 : static_cast<uint32_t>(wire.pts.size() - 1);
+    it.frontIsPin = !wire.pts.empty() && wire.pts.front().type == CPType::Pin;
+    it.backIsPin = !wire.pts.empty() && wire.pts.back().type == CPType::Pin;
+
+    std::sort(points.begin(), points.end());
+    points.erase(std::unique(points.begin(), points.end()), points.end());
+    it.points = std::move(points);
+}
+
+void Netlist::AddPinItems(size_t elemIdx, const CanvasElement& elem)
+{
+    auto add = [&](const std::vector<wxPoint>& pins, bool isInput, std::vector<int>& out) {
+        out.clear();
+        for (size_t k = 0; k < pins.size(); ++k) {
+            int id = NewItem();
+            int point = PointOf(pins[k]);
+            Item& it = m_items[id];
+            it.isInput = isInput;
+            it.index = static_cast<uint32_t>(elemIdx);
+            it.pin = static_cast<uint32_t>(k);
+            it.points.push_back(point);
+            out.push_back(id);
+            Attach(id);
+        }
+        };
+    add(elem.GetInputPinWorld(), true, m_elemPins[elemIdx].inputs);
+    add(elem.GetOutputPinWorld(), false, m_elemPins[elemIdx].outputs);
+}
+
+//---------------- 全量重建 ----------------
+void Netlist::Build(const std::vector<CanvasElement>& elements,
+    const std::vector<Wire>& wires,
+    const std::vector<WireWireAnchor>& anchors)
+{
+    Clear();
+
+    // 先建立全部结点和坐标点，不做网络合并
+    auto place = [&](int id) {
+        for (int p : m_items[id].points) m_points[p].items.push_back(id);
+        };
+    m_wireItem.resize(wires.size());
+    for (size_t w = 0; w < wires.size(); ++w) {
+        int id = NewItem();
+        m_items[id].isWire = true;
+        m_items[id].index = static_cast<uint32_t>(w);
+        SetWirePoints(id, wires[w]);
+        place(id);
+        m_wireItem[w] = id;
+    }
+    m_elemPins.resize(elements.size());
+    for (size_t e = 0; e < elements.size(); ++e) {
+        const auto& elem = elements[e];
+        auto add = [&](const std::vector<wxPoint>& pins, bool isInput, std::vector<int>& out) {
+            for (size_t k = 0; k < pins.size(); ++k) {
+                int id = NewItem();
+                Item& it = m_items[id];
+                it.isInput = isInput;
+                it.index = static_cast<uint32_t>(e);
+                it.pin = static_cast<uint32_t>(k);
+                it.points.push_back(PointOf(pins[k]));
+                place(id);
+                out.push_back(id);
+            }
+            };
+        add(elem.GetInputPinWorld(), true, m_elemPins[e].inputs);
+        add(elem.GetOutputPinWorld(), false, m_elemPins[e].outputs);
+    }
+    for (const auto& a : anchors) {
+        if (a.srcWire >= wires.size() || a.dstWire >= wires.size() || a.srcWire == a.dstWire) continue;
+        int src = m_wireItem[a.srcWire], dst = m_wireItem[a.dstWire];
+        auto& links = m_items[src].links;
+        if (std::find(links.begin(), links.end(), dst) != links.end()) continue;
+        links.push_back(dst);
+        m_items[dst].links.push_back(src);
+    }
+
+    // 并查集一次性归并，再把根映射为网络
+    DisjointSet ds;
+    ds.Reset(m_items.size());
+    for (const auto& pt : m_points)
+        for (size_t i = 1; i < pt.items.size(); ++i)
+            ds.Unite(pt.items.front(), pt.items[i]);
+    for (size_t i = 0; i < m_items.size(); ++i)
+        for (int other : m_items[i].links)
+            ds.Unite(static_cast<int>(i), other);
+
+    std::vector<int> netOfRoot(m_items.size(), -1);
+    for (size_t i = 0; i < m_items.size(); ++i) {
+        int root = ds.Find(static_cast<int>(i));
+        if (netOfRoot[root] == -1) netOfRoot[root] = NewNet();
+        JoinNet(static_cast<int>(i), netOfRoot[root]);
+    }
+
+    MyLog("Netlist::Build: elements=%zu wires=%zu anchors=%zu nets=%d\n",
+        elements.size(), wires.size(), anchors.size(), m_liveNets);
+}
+
+//---------------- 增量修改 ----------------
+void Netlist::AddElement(const CanvasElement& elem)
+{
+    m_elemPins.emplace_back();
+    AddPinItems(m_elemPins.size() - 1, elem);
+    ++m_revision;
+}
+
+void Netlist::MoveElement(size_t elemIdx, const CanvasElement& elem)
+{
+    if (elemIdx >= m_elemPins.size()) return;
+    for (auto* pins : { &m_elemPins[elemIdx].inputs, &m_elemPins[elemIdx].outputs })
+        for (int id : *pins) {
+            Detach(id);
+            FreeItem(id);
+        }
+    AddPinItems(elemIdx, elem);
+    ++m_revision;
+}
+
+void Netlist::RemoveElement(size_t elemIdx)
+{
+    if (elemIdx >= m_elemPins.size()) return;
+    for (auto* pins : { &m_elemPins[elemIdx].inputs, &m_elemPins[elemIdx].outputs })
+        for (int id : *pins) {
+            Detach(id);
+            FreeItem(id);
+        }
+    // 与画布的 SlotMap 一致：最后一个元件搬到被删位置
+    if (elemIdx + 1 != m_elemPins.size()) {
+        m_elemPins[elemIdx] = std::move(m_elemPins.back());
+        for (int id : m_elemPins[elemIdx].inputs) m_items[id].index = static_cast<uint32_t>(elemIdx);
+        for (int id : m_elemPins[elemIdx].outputs) m_items[id].index = static_cast<uint32_t>(elemIdx);
+    }
+    m_elemPins.pop_back();
+    ++m_revision;
+    ++m_layoutRevision;
+}
+
+void Netlist::AddWire(const Wire& wire)
+{
+    int id = NewItem();
+    m_items[id].isWire = true;
+    m_items[id].index = static_cast<uint32_t>(m_wireItem.size());
+    m_wireItem.push_back(id);
+    SetWirePoints(id, wire);
+    Attach(id);
+    ++m_revision;
+}
+
+void Netlist::UpdateWire(size_t wireIdx, const Wire& wire)
+{
+    if (wireIdx >= m_wireItem.size()) return;
+    int id = m_wireItem[wireIdx];
+
+    // 原有的 T 型连接一并摘掉：形状变了，由调用方按新位置重新识别后 AddAnchor
+    Detach(id);
+    SetWirePoints(id, wire);
+    Attach(id);
+    ++m_revision;
+}
+
+void Netlist::RemoveWire(size_t wireIdx)
+{
+    if (wireIdx >= m_wireItem.size()) return;
+    int id = m_wireItem[wireIdx];
+    Detach(id);
+    FreeItem(id);
+    if (wireIdx + 1 != m_wireItem.size()) {
+        m_wireItem[wireIdx] = m_wireItem.back();
+        m_items[m_wireItem[wireIdx]].index = static_cast<uint32_t>(wireIdx);
+    }
+    m_wireItem.pop_back();
+    ++m_revision;
+}
+
+void Netlist::AddAnchor(const WireWireAnchor& anchor)
+{
+    if (anchor.srcWire >= m_wireItem.size() || anchor.dstWire >= m_wireItem.size()) return;
+    int src = m_wireItem[anchor.srcWire], dst = m_wireItem[anchor.dstWire];
+    if (src == dst) return;
+    auto& links = m_items[src].links;
+    if (std::find(links.begin(), links.end(), dst) != links.end()) return;
+    links.push_back(dst);
+    m_items[dst].links.push_back(src);
+
+    int a = m_items[src].net, b = m_items[dst].net;
+    if (a != b) {
+        if (m_nets[a].items.size() < m_nets[b].items.size()) std::swap(a, b);
+        MergeNets(b, a);
+    }
+    ++m_revision;
+}
+
+//---------------- 查询 ----------------
+int Netlist::GetWireNet(size_t wireIdx) const
+{
+    return wireIdx < m_wireItem.size() ? m_items[m_wireItem[wireIdx]].net : -1;
+}
+
+int Netlist::GetPinNet(size_t elemIdx, bool isInput, size_t pinIdx) const
+{
+    if (elemIdx >= m_elemPins.size()) return -1;
+    const auto& pins = isInput ? m_elemPins[elemIdx].inputs : m_elemPins[elemIdx].outputs;
+    return pinIdx < pins.size() ? m_items[pins[pinIdx]].net : -1;
+}
+
+void Netlist::GetPinWires(size_t elemIdx, bool isInput, size_t pinIdx,
+    std::vector<std::pair<size_t, size_t>>& out) const
+{
+    if (elemIdx >= m_elemPins.size()) return;
+    const auto& pins = isInput ? m_elemPins[elemIdx].inputs : m_elemPins[elemIdx].outputs;
+    if (pinIdx >= pins.size()) return;
+
+    int point = m_items[pins[pinIdx]].points.front();
+    for (int id : m_points[point].items) {
+        const Item& it = m_items[id];
+        if (!it.isWire) continue;
+        if (it.front == point && it.frontIsPin) out.emplace_back(it.index, 0);
+        if (it.last > 0 && it.back == point && it.backIsPin) out.emplace_back(it.index, it.last);
+    }
+}
+
+void Netlist::FindTJunctions(const std::vector<Wire>& wires, std::vector<WireWireAnchor>& out)
+{
+    // 按行/列把水平、竖直线段分桶，端点只需检查同一行/列上的线段
+    struct SegRef { int lo, hi; size_t wire, seg; };
+    std::unordered_map<int, std::vector<SegRef>> rows, cols;
+    for (size_t w = 0; w < wires.size(); ++w) {
+        const auto& pts = wires[w].pts;
+        for (size_t i = 1; i < pts.size(); ++i) {
+            const wxPoint& a = pts[i - 1].pos;
+            const wxPoint& b = pts[i].pos;
+            if (a.y == b.y && a.x != b.x)
+                rows[a.y].push_back({ std::min(a.x, b.x), std::max(a.x, b.x), w, i - 1 });
+            else if (a.x == b.x && a.y != b.y)
+                cols[a.x].push_back({ std::min(a.y, b.y), std::max(a.y, b.y), w, i - 1 });
+        }
+    }
+
+    auto probe = [&](size_t w, size_t ptIdx) {
+        const wxPoint& p = wires[w].pts[ptIdx].pos;
+        auto scan = [&](const std::unordered_map<int, std::vector<SegRef>>& buckets, int key, int v) {
+            auto it = buckets.find(key);
+            if (it == buckets.end()) return false;
+            for (const auto& s : it->second) {
+                if (s.wire != w && v >= s.lo && v <= s.hi && !IsWireEnd(p, wires[s.wire].pts)) {
+                    out.push_back({ w, ptIdx, s.wire, s.seg });
+                    return true;
+                }
+            }
+            return false;
+            };
+        if (!scan(rows, p.y, p.x)) scan(cols, p.x, p.y);
+        };
+
+    for (size_t w = 0; w < wires.size(); ++w) {
+        const auto& pts = wires[w].pts;
+        if (pts.size() < 2) continue;
+        if (pts.front().type != CPType::Pin) probe(w, 0);
+        if (pts.back().type != CPType::Pin) probe(w, pts.size() - 1);
+    }
+}
+
+void Netlist::FindTJunctions(const std::vector<Wire>& wires, size_t w,
+    const std::vector<size_t>& candidates, std::vector<WireWireAnchor>& out)
+{
+    if (w >= wires.size() || wires[w].pts.size() < 2) return;
+
+    // 端点 (src, ptIdx) 落在 dst 的线段内部或中间折点上时记录一次
+    auto probe = [&](size_t src, size_t ptIdx, size_t dst) {
+        const wxPoint& p = wires[src].pts[ptIdx].pos;
+        const auto& other = wires[dst].pts;
+        if (IsWireEnd(p, other)) return false;
+        for (size_t i = 1; i < other.size(); ++i) {
+            if (OnSegment(p, other[i - 1].pos, other[i].pos)) {
+                out.push_back({ src, ptIdx, dst, i - 1 });
+                return true;
+            }
+        }
+        return false;
+        };
+
+    for (size_t o : candidates) {
+        if (o == w || o >= wires.size() || wires[o].pts.size() < 2) continue;
+        // 新导线的端点接到已有导线上
+        for (size_t ptIdx : { size_t(0), wires[w].pts.size() - 1 })
+            if (wires[w].pts[ptIdx].type != CPType::Pin) probe(w, ptIdx, o);
+        // 已有导线的端点落在新导线上
+        for (size_t ptIdx : { size_t(0), wires[o].pts.size() - 1 })
+            if (wires[o].pts[ptIdx].type != CPType::Pin) probe(o, ptIdx, w);
+    }
+}
@@ -0,0 +1,149 @@
+﻿#pragma once
+#include <wx/wx.h>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include "CanvasElement.h"
+#include "Wire.h"
+
+// 并查集：路径压缩 + 按大小合并，均摊近似 O(1)
+class DisjointSet
+{
+public:
+    void   Reset(size_t n);
+    int    Add();                  // 新增一个单元素集合，返回其编号
+    int    Find(int x);
+    bool   Unite(int a, int b);    // 已在同一集合时返回 false
+    size_t Size() const { return m_parent.size(); }
+
+private:
+    std::vector<int> m_parent;
+    std::vector<int> m_size;
+};
+
+/*
+ * 连通性网表：把导线端点、控制点、导线 T 型连接和元件引脚归并为网络
+ * - 坐标完全重合的点属于同一节点
+ * - 同一根导线上的所有控制点互相连通
+ * - WireWireAnchor 记录的 T 型连接把两根导线连通
+ * 未连接任何导线的引脚也会得到自己的网络编号
+ *
+ * 网表常驻并接受增量修改（导线/元件的增、删、移动），下标与画布的
+ * m_wires / m_elements 保持一致（删除同样是把最后一个对象移到空位）：
+ * - 合并时把小网络并入大网络，只改写小网络的成员
+ * - 删除时从被删对象的邻居出发做 BFS，所有邻居都已连通就立即停止，
+ *   只有真正断开的部分才分配新网络
+ * 网络编号在修改之间保持稳定（释放的编号会复用），因此不一定连续；
+ * 每次修改涉及的网络记录在 GetChangedNets() 中，供仿真/绘制按需更新
+ */
+class Netlist
+{
+public:
+    // 全量重建（打开文件后使用）
+    void Build(const std::vector<CanvasElement>& elements,
+        const std::vector<Wire>& wires,
+        const std::vector<WireWireAnchor>& anchors);
+    void Clear();
+
+    // 增量修改：调用方在修改画布容器的同时调用，保持下标一致
+    void AddElement(const CanvasElement& elem);                 // 追加到末尾
+    void MoveElement(size_t elemIdx, const CanvasElement& elem); // 位置变化后重新挂接引脚
+    void RemoveElement(size_t elemIdx);                         // 最后一个元件移到 elemIdx
+    void AddWire(const Wire& wire);                             // 追加到末尾
+    void UpdateWire(size_t wireIdx, const Wire& wire);          // 控制点变化；原有 T 型连接被去掉
+    void RemoveWire(size_t wireIdx);                            // 同时去掉它参与的 T 型连接；最后一根导线移到 wireIdx
+    void AddAnchor(const WireWireAnchor& anchor);
+
+    int GetNetCount() const { return m_liveNets; }                             // 现存网络数
+    int GetNetCapacity() const { return static_cast<int>(m_nets.size()); }    // 网络编号上界
+    int GetWireNet(size_t wireIdx) const;
+    int GetPinNet(size_t elemIdx, bool isInput, size_t pinIdx) const;
+
+    size_t GetElementCount() const { return m_elemPins.size(); }
+    size_t GetWireCount() const { return m_wireItem.size(); }
+
+    // 与引脚直接相连的导线端点：first 为导线下标，second 为控制点下标（0 或最后）
+    void GetPinWires(size_t elemIdx, bool isInput, size_t pinIdx,
+        std::vector<std::pair<size_t, size_t>>& out) const;
+
+    // 自上次 ClearChangedNets() 以来被修改过的网络（含已被合并/释放的编号）
+    const std::vector<int>& GetChangedNets() const { return m_changed; }
+    void ClearChangedNets();
+    uint64_t GetRevision() const { return m_revision; }   // 每次修改递增
+    // 元件下标被打乱（删除元件时最后一个元件搬到空位、整体重建）时递增，
+    // 依赖元件下标的增量更新需要退回全量重建；追加元件、改动导线或移动元件时不变
+    uint64_t GetLayoutRevision() const { return m_layoutRevision; }
+
+    // 查找导线端点落在其他导线线段内部或中间折点上的 T 型连接
+    static void FindTJunctions(const std::vector<Wire>& wires, std::vector<WireWireAnchor>& out);
+    // 只检查 wires[w] 与 candidates 中导线之间的 T 型连接（新画完或修改一根导线时使用），
+    // candidates 由调用方用线段索引查出，通常只是附近几根
+    static void FindTJunctions(const std::vector<Wire>& wires, size_t w,
+        const std::vector<size_t>& candidates, std::vector<WireWireAnchor>& out);
+
+private:
+    // 连通图的结点：导线或引脚；坐标点把重合的引脚、导线首尾端点连在一起
+    struct Item {
+        bool     isWire = false;
+        bool     isInput = false;     // 引脚方向
+        bool     frontIsPin = false;  // 导线端点是否为 CPType::Pin
+        bool     backIsPin = false;
+        uint32_t index = 0;           // 导线下标或元件下标
+        uint32_t pin = 0;             // 引脚下标
+        int      front = -1;          // 导线首/尾控制点所在坐标点
+        int      back = -1;
+        uint32_t last = 0;            // 导线最后一个控制点下标
+        std::vector<int> points;      // 去重后的坐标点
+        std::vector<int> links;       // T 型连接到的其他导线
+        int      net = -1;
+        uint32_t netSlot = 0;         // 在 Net::items 中的位置
+    };
+    struct Point {
+        uint64_t key = 0;
+        std::vector<int> items;
+    };
+    struct Net {
+        std::vector<int> items;
+    };
+    struct ElementPins {
+        std::vector<int> inputs;
+        std::vector<int> outputs;
+    };
+
+    int  NewItem();
+    void FreeItem(int item);
+    int  NewNet();
+    int  PointOf(const wxPoint& p);
+    void SetWirePoints(int item, const Wire& wire);
+    void AddPinItems(size_t elemIdx, const CanvasElement& elem);
+    void Attach(int item);                       // 挂接到坐标点并合并相邻网络
+    void Detach(int item);                       // 摘下并处理可能的网络分裂
+    void JoinNet(int item, int net);
+    void LeaveNet(int item);
+    void MergeNets(int from, int into);
+    void SplitAfterRemoval(int net, std::vector<int>& neighbours);
+    void MarkChanged(int net);
+    template <class Fn> void ForEachNeighbour(int item, Fn fn) const;
+
+    std::vector<Item>  m_items;
+    std::vector<int>   m_freeItems;
+    std::vector<Point> m_points;
+    std::vector<int>   m_freePoints;
+    std::unordered_map<uint64_t, int> m_pointIndex;
+    std::vector<Net>   m_nets;
+    std::vector<int>   m_freeNets;
+    int m_liveNets = 0;
+
+    std::vector<int>         m_wireItem;   // 导线下标 -> 结点
+    std::vector<ElementPins> m_elemPins;   // 元件下标 -> 引脚结点
+
+    std::vector<int>      m_changed;
+    std::vector<uint8_t>  m_changedFlag;
+    uint64_t              m_revision = 0;
+    uint64_t              m_layoutRevision = 0;
+
+    // BFS 工作区（复用容量）
+    std::vector<uint32_t> m_visit;
+    uint32_t              m_visitStamp = 0;
+    std::vector<int>      m_queue;
+};
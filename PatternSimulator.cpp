@@ -0,0 +1,273 @@
+﻿#include "PatternSimulator.h"
+#include "my_log.h"
+#include <algorithm>
+
+void PatternSimulator::Clear()
+{
+    m_ops.clear();
+    m_opInputs.clear();
+    m_groups.clear();
+    m_groupInputs.clear();
+    m_groupNegate.clear();
+    m_inputs.clear();
+    m_outputs.clear();
+    m_words.clear();
+    m_wordCount = 0;
+    m_evalCount = 0;
+    m_gateCount = 0;
+    m_error.clear();
+}
+
+bool PatternSimulator::Build(const Simulator& sim)
+{
+    Clear();
+    if (!sim.IsBuilt()) {
+        m_error = "仿真模型尚未构建";
+        return false;
+    }
+    if (sim.GetLoopCount() != 0) {
+        m_error = wxString::Format("电路含 %zu 个反馈环，批量仿真只支持组合电路", sim.GetLoopCount());
+        return false;
+    }
+    const CompiledNetlist& net = sim.GetCompiled();
+    for (uint32_t n = 0; n < net.NetCount(); ++n) {
+        if (net.driverStart[n + 1] - net.driverStart[n] > 1) {
+            m_error = "存在多个输出驱动同一网络，批量仿真不支持";
+            return false;
+        }
+    }
+
+    // 字 0/1 是常量；输入源先按元件顺序分配
+    const uint32_t kUndriven = UINT32_MAX;
+    std::vector<uint32_t> wordOfNet(net.NetCount(), kUndriven);
+    std::vector<uint32_t> wordOfGate(net.GateCount(), kZeroWord);
+    m_wordCount = 2;
+    for (uint32_t g = 0; g < net.GateCount(); ++g) {
+        if (net.kind[g] != GateKind::Source && net.kind[g] != GateKind::Clock) continue;
+        wordOfGate[g] = m_wordCount++;
+        m_inputs.push_back({ g, wordOfGate[g] });
+    }
+
+    // 按拓扑序编成指令：驱动者总在读者之前，读到的网络都已分配了字
+    for (uint32_t g : sim.GetLevelOrder()) {
+        const GateKind kind = net.kind[g];
+        BitOp op = BitOp::Copy;
+        bool invert = false, isGate = true;
+        switch (kind) {
+        case GateKind::Source:
+        case GateKind::Clock:
+        case GateKind::Sink:        isGate = false; break;
+        case GateKind::Constant:
+        case GateKind::Power:       isGate = false; wordOfGate[g] = kOnesWord; break;
+        case GateKind::Ground:      isGate = false; wordOfGate[g] = kZeroWord; break;
+        case GateKind::Buffer:
+        case GateKind::Passthrough: op = BitOp::Copy; break;
+        case GateKind::Not:         op = BitOp::Copy; invert = true; break;
+        case GateKind::And:         op = BitOp::And; break;
+        case GateKind::Nand:        op = BitOp::And; invert = true; break;
+        case GateKind::Or:          op = BitOp::Or; break;
+        case GateKind::Nor:         op = BitOp::Or; invert = true; break;
+        case GateKind::Xor:
+        case GateKind::OddParity:   op = BitOp::Xor; break;
+        case GateKind::Xnor:
+        case GateKind::EvenParity:  op = BitOp::Xor; invert = true; break;
+        default:
+            m_error = wxString::Format("第 %u 个元件不支持批量仿真（三态门、上拉电阻或未建模的元件）", g);
+            return false;
+        }
+
+        if (isGate) {
+            // 缓冲类只看第一个输入；悬空的输入跳过，取反位随保留下来的输入重新编号
+            const uint32_t first = static_cast<uint32_t>(m_opInputs.size());
+            const uint32_t last = op == BitOp::Copy ? std::min(net.inStart[g] + 1, net.inStart[g + 1]) : net.inStart[g + 1];
+            uint8_t negate = 0;
+            for (uint32_t i = net.inStart[g]; i < last && i - net.inStart[g] < 8; ++i) {
+                if (wordOfNet[net.inNet[i]] == kUndriven) continue;
+                if ((net.negate[g] >> (i - net.inStart[g])) & 1)
+                    negate |= static_cast<uint8_t>(1u << (m_opInputs.size() - first));
+                m_opInputs.push_back(wordOfNet[net.inNet[i]]);
+            }
+            const uint32_t count = static_cast<uint32_t>(m_opInputs.size()) - first;
+            if (count == 0) {
+                wordOfGate[g] = kZeroWord;
+            }
+            else if (op == BitOp::Copy && !invert) {
+                wordOfGate[g] = m_opInputs[first];   // 纯缓冲直接沿用输入的字
+                m_opInputs.resize(first);
+            }
+            else {
+                wordOfGate[g] = m_wordCount++;
+                m_ops.push_back({ op, invert, negate, static_cast<uint16_t>(count), first, wordOfGate[g] });
+            }
+        }
+        for (uint32_t slot = net.outStart[g]; slot < net.outStart[g + 1]; ++slot)
+            wordOfNet[net.slotNet[slot]] = wordOfGate[g];
+    }
+
+    for (uint32_t g = 0; g < net.GateCount(); ++g) {
+        if (net.kind[g] != GateKind::Sink) continue;
+        uint32_t word = kZeroWord;
+        if (net.inStart[g] < net.inStart[g + 1] && wordOfNet[net.inNet[net.inStart[g]]] != kUndriven)
+            word = wordOfNet[net.inNet[net.inStart[g]]];
+        m_outputs.push_back({ g, word });
+    }
+
+    BuildGroups();
+    SetLanes(m_lanes);
+    MyLog("PatternSimulator::Build: inputs=%zu outputs=%zu gates=%zu groups=%zu words=%u kernel=%s\n",
+        m_inputs.size(), m_outputs.size(), m_gateCount, m_groups.size(), m_wordCount, KernelIsaName(m_isa));
+    return true;
+}
+
+// 按层分组：层号 = 输入中最大的层号 + 1；同层的门互不依赖，
+// 再按类型、取反、输入数排序，相同的排成一组并把输出字重新编成连续的一段
+void PatternSimulator::BuildGroups()
+{
+    const uint32_t firstOpWord = 2 + static_cast<uint32_t>(m_inputs.size());
+    std::vector<uint32_t> levelOfWord(m_wordCount, 0);
+    std::vector<uint32_t> level(m_ops.size(), 0);
+    for (size_t i = 0; i < m_ops.size(); ++i) {
+        const Op& op = m_ops[i];
+        uint32_t lv = 0;
+        for (uint32_t k = 0; k < op.inputCount; ++k)
+            lv = std::max(lv, levelOfWord[m_opInputs[op.firstInput + k]]);
+        level[i] = lv + 1;
+        levelOfWord[op.out] = lv + 1;
+    }
+
+    std::vector<uint32_t> order(m_ops.size());
+    for (size_t i = 0; i < order.size(); ++i) order[i] = static_cast<uint32_t>(i);
+    std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+        const Op& x = m_ops[a];
+        const Op& y = m_ops[b];
+        if (level[a] != level[b]) return level[a] < level[b];
+        if (x.op != y.op) return x.op < y.op;
+        if (x.invert != y.invert) return x.invert < y.invert;
+        return x.inputCount < y.inputCount;
+    });
+
+    // 输出字按排序后的顺序重新编号；输入源和常量的字不变
+    std::vector<uint32_t> remap(m_wordCount);
+    for (uint32_t w = 0; w < firstOpWord; ++w) remap[w] = w;
+    for (size_t k = 0; k < order.size(); ++k)
+        remap[m_ops[order[k]].out] = firstOpWord + static_cast<uint32_t>(k);
+    for (Port& port : m_outputs) port.word = remap[port.word];
+
+    m_groups.clear();
+    m_groupInputs.clear();
+    m_groupNegate.clear();
+    m_groupInputs.reserve(m_opInputs.size());
+    std::vector<size_t> inputOffset, negateOffset;
+    for (size_t begin = 0; begin < order.size();) {
+        const Op& head = m_ops[order[begin]];
+        size_t end = begin + 1;
+        while (end < order.size()) {
+            const Op& op = m_ops[order[end]];
+            if (level[order[end]] != level[order[begin]] || op.op != head.op ||
+                op.invert != head.invert || op.inputCount != head.inputCount) break;
+            ++end;
+        }
+        GateGroup g;
+        g.op = head.op;
+        g.invert = head.invert;
+        g.arity = head.inputCount;
+        g.count = static_cast<uint32_t>(end - begin);
+        g.firstOut = firstOpWord + static_cast<uint32_t>(begin);
+        inputOffset.push_back(m_groupInputs.size());
+        for (uint32_t k = 0; k < g.arity; ++k)
+            for (size_t i = begin; i < end; ++i)
+                m_groupInputs.push_back(remap[m_opInputs[m_ops[order[i]].firstInput + k]]);
+        // 组内没有取反的输入时 negate 留空，内核走原来的路径
+        const bool negated = std::any_of(order.begin() + begin, order.begin() + end,
+            [&](uint32_t o) { return m_ops[o].negate != 0; });
+        negateOffset.push_back(negated ? m_groupNegate.size() : SIZE_MAX);
+        if (negated)
+            for (size_t i = begin; i < end; ++i) m_groupNegate.push_back(m_ops[order[i]].negate);
+        m_groups.push_back(g);
+        begin = end;
+    }
+    for (size_t i = 0; i < m_groups.size(); ++i) {
+        m_groups[i].inputs = m_groupInputs.data() + inputOffset[i];
+        if (negateOffset[i] != SIZE_MAX) m_groups[i].negate = m_groupNegate.data() + negateOffset[i];
+    }
+
+    m_gateCount = m_ops.size();
+    m_ops.clear();
+    m_opInputs.clear();
+}
+
+bool PatternSimulator::SetKernelIsa(KernelIsa isa)
+{
+    if (!IsKernelIsaSupported(isa)) return false;
+    m_isa = isa;
+    m_kernel = GetGateKernel(isa);
+    return true;
+}
+
+void PatternSimulator::SetLanes(size_t lanes)
+{
+    m_lanes = std::max<size_t>(1, lanes);
+    m_words.assign(static_cast<size_t>(m_wordCount) * m_lanes, 0);
+    FillConstants();
+}
+
+void PatternSimulator::FillConstants()
+{
+    if (m_wordCount < 2) return;
+    std::fill(m_words.begin(), m_words.begin() + m_lanes, 0);
+    std::fill(m_words.begin() + m_lanes, m_words.begin() + 2 * m_lanes, ~0ull);
+}
+
+void PatternSimulator::Evaluate()
+{
+    uint64_t* w = m_words.data();
+    for (const GateGroup& g : m_groups) m_kernel(w, m_lanes, g);
+    m_evalCount += m_gateCount;
+}
+
+uint64_t PatternSimulator::RunExhaustive(const BatchFn& fn)
+{
+    const size_t n = m_inputs.size();
+    if (n >= 63) return 0;
+    // 组序号的第 i 位就是第 i 个输入；低 6 位在一个字内按固定花样变化
+    static const uint64_t kLowBits[6] = {
+        0xAAAAAAAAAAAAAAAAull, 0xCCCCCCCCCCCCCCCCull, 0xF0F0F0F0F0F0F0F0ull,
+        0xFF00FF00FF00FF00ull, 0xFFFF0000FFFF0000ull, 0xFFFFFFFF00000000ull,
+    };
+    const uint64_t total = 1ull << n;
+    const uint64_t batch = GetBatchSize();
+    for (uint64_t first = 0; first < total; first += batch) {
+        for (size_t i = 0; i < n; ++i) {
+            uint64_t* words = InputWords(i);
+            for (size_t l = 0; l < m_lanes; ++l) {
+                const uint64_t base = first + 64 * l;
+                words[l] = i < 6 ? kLowBits[i] : (((base >> i) & 1) ? ~0ull : 0);
+            }
+        }
+        Evaluate();
+        if (fn && !fn(*this, first)) return std::min(first + batch, total);
+    }
+    return total;
+}
+
+uint64_t PatternSimulator::RunRandom(uint64_t count, uint64_t seed, const BatchFn& fn)
+{
+    uint64_t state = seed ? seed : 0x9E3779B97F4A7C15ull;
+    const uint64_t batch = GetBatchSize();
+    uint64_t first = 0;
+    for (; first < count; first += batch) {
+        for (size_t i = 0; i < m_inputs.size(); ++i) {
+            uint64_t* words = InputWords(i);
+            for (size_t l = 0; l < m_lanes; ++l) {
+                // xorshift64*
+                state ^= state >> 12;
+                state ^= state << 25;
+                state ^= state >> 27;
+                words[l] = state * 0x2545F4914F6CDD1Dull;
+            }
+        }
+        Evaluate();
+        if (fn && !fn(*this, first)) return first + batch;
+    }
+    return first;
+}
@@ -0,0 +1,93 @@
+﻿#pragma once
+#include <wx/wx.h>
+#include <vector>
+#include <cstdint>
+#include <functional>
+#include "Simulator.h"
+#include "GateKernels.h"
+
+/*
+ * 位并行的批量仿真：每个网络的值是 lanes 个 64 位字，第 k 位对应第 k 组输入，
+ * 一次求值同时算出 64 * lanes 组互不相关的输入向量，用于穷举或随机向量回归
+ * - 只处理无反馈环的组合电路，按 Simulator 层次化得到的拓扑序一遍求值
+ * - 两值逻辑：AND/OR/XOR（含奇偶校验）和缓冲各是一条按位指令，取反由一个标志完成；
+ *   元件属性 "Negate N" 取反的输入按门记一个掩码，只有用到的组才带 negate 数组
+ * - 指令按层分组，层内再按类型和输入数排成 GateGroup，交给 GateKernels 的
+ *   SIMD 内核一次处理一整组（默认按 CPU 选择，可用 SetKernelIsa 指定）
+ * - 悬空的输入与事件仿真一样视为未连接；输入全部悬空的门输出按 0 计
+ *   （事件仿真中为 Unknown）
+ * - Pin (Output) 和时钟是输入，Pin (Input) 和探针是输出，下标按画布元件顺序
+ * 多驱动网络、三态门、上拉电阻和未建模的元件不支持，Build 返回 false
+ */
+class PatternSimulator
+{
+public:
+    // 每批调用一次：firstPattern 为这一批第一组输入的序号；返回 false 时提前停止
+    using BatchFn = std::function<bool(const PatternSimulator&, uint64_t firstPattern)>;
+
+    bool Build(const Simulator& sim);
+    void Clear();
+    const wxString& GetError() const { return m_error; }
+
+    void   SetLanes(size_t lanes);     // 每个网络的 64 位字数，默认 1
+    size_t GetLanes() const { return m_lanes; }
+    size_t GetBatchSize() const { return 64 * m_lanes; }
+
+    bool      SetKernelIsa(KernelIsa isa);   // 当前 CPU 不支持时返回 false，保持原内核
+    KernelIsa GetKernelIsa() const { return m_isa; }
+    size_t    GetGroupCount() const { return m_groups.size(); }
+
+    size_t GetInputCount() const { return m_inputs.size(); }
+    size_t GetOutputCount() const { return m_outputs.size(); }
+    size_t GetInputElement(size_t i) const { return m_inputs[i].elem; }
+    size_t GetOutputElement(size_t i) const { return m_outputs[i].elem; }
+
+    // 输入/输出的值：lanes 个字
+    uint64_t*       InputWords(size_t i) { return &m_words[m_inputs[i].word * m_lanes]; }
+    const uint64_t* OutputWords(size_t i) const { return &m_words[m_outputs[i].word * m_lanes]; }
+
+    void Evaluate();   // 用当前输入算一批
+    size_t GetEvaluationCount() const { return m_evalCount; }   // 累计门求值次数（每次覆盖一整批）
+
+    // 按序号穷举全部 2^输入数 组输入，返回实际算过的组数；第 k 组的第 i 个输入取序号的第 i 位，
+    // 最后一批多出的位序号超出范围，对应的输入按序号取模，即重复前面的组
+    uint64_t RunExhaustive(const BatchFn& fn);
+    // count 组伪随机输入（向上取整到整批），返回实际算过的组数
+    uint64_t RunRandom(uint64_t count, uint64_t seed, const BatchFn& fn);
+
+private:
+    struct Op {
+        BitOp    op;
+        bool     invert;
+        uint8_t  negate;       // 第 k 位：保留下来的第 k 个输入取反
+        uint16_t inputCount;
+        uint32_t firstInput;   // m_opInputs 中的起始下标
+        uint32_t out;          // 结果所在的字
+    };
+    struct Port {
+        size_t   elem;
+        uint32_t word;
+    };
+
+    static constexpr uint32_t kZeroWord = 0;
+    static constexpr uint32_t kOnesWord = 1;
+
+    void FillConstants();
+    void BuildGroups();
+
+    std::vector<Op>       m_ops;          // 拓扑序，只在构建时使用
+    std::vector<uint32_t> m_opInputs;     // 输入所在的字
+    std::vector<GateGroup> m_groups;      // 按层排列，inputs 指向 m_groupInputs
+    std::vector<uint32_t> m_groupInputs;
+    std::vector<uint8_t>  m_groupNegate;  // 含取反输入的组的 negate 数组
+    std::vector<Port>     m_inputs;
+    std::vector<Port>     m_outputs;
+    std::vector<uint64_t> m_words;        // 字 w 占 [w*lanes, (w+1)*lanes)
+    uint32_t m_wordCount = 0;
+    size_t   m_lanes = 1;
+    size_t   m_evalCount = 0;
+    size_t   m_gateCount = 0;             // 每批求值的门数
+    KernelIsa  m_isa = DetectKernelIsa();
+    GateKernel m_kernel = GetGateKernel(DetectKernelIsa());
+    wxString m_error;
+};
@@ -0,0 +1,119 @@
+﻿#include "RenderWorker.h"
+#include <wx/dcgraph.h>
+#include <wx/graphics.h>
+#include <cmath>
+#include <cstring>
+
+RenderWorker::RenderWorker(std::function<void()> onFrameReady)
+    : m_onFrameReady(std::move(onFrameReady)),
+      m_thread(&RenderWorker::Run, this)
+{
+}
+
+RenderWorker::~RenderWorker()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_cv.notify_one();
+    m_thread.join();
+}
+
+void RenderWorker::Submit(RenderRequest req)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_pending = std::move(req);
+        m_hasRequest = true;
+    }
+    m_cv.notify_one();
+}
+
+bool RenderWorker::TakeFrame(RenderedFrame& out)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_hasFrame) return false;
+    std::swap(out, m_ready);
+    m_hasFrame = false;
+    return true;
+}
+
+void RenderWorker::Run()
+{
+    RenderedFrame back;
+    for (;;) {
+        RenderRequest req;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cv.wait(lock, [this] { return m_stop || m_hasRequest; });
+            if (m_stop) return;
+            req = std::move(m_pending);
+            m_hasRequest = false;
+        }
+        if (!Rasterize(req, back, m_stop)) return;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            std::swap(back, m_ready);   // 未被取走的旧帧换回来复用
+            m_hasFrame = true;
+        }
+        if (m_onFrameReady) m_onFrameReady();
+    }
+}
+
+bool RenderWorker::Rasterize(const RenderRequest& req, RenderedFrame& out, const std::atomic<bool>& abort)
+{
+    const int w = std::max(1, req.size.x), h = std::max(1, req.size.y);
+    out.scale = req.scale;
+    out.offset = req.offset;
+    out.version = req.scene ? req.scene->version : 0;
+    out.geometry = req.scene ? req.scene->geometry : nullptr;
+    if (!out.image.IsOk() || out.image.GetWidth() != w || out.image.GetHeight() != h)
+        out.image = wxImage(w, h, false);
+    std::memset(out.image.GetData(), 255, static_cast<size_t>(w) * h * 3);
+    if (!req.scene || !req.scene->geometry) return true;
+    const SceneGeometry& scene = *req.scene->geometry;
+    const std::vector<wxColour>& colours = req.scene->wireColours;
+
+    wxGraphicsContext* gc = wxGraphicsContext::Create(out.image);
+    if (!gc) return true;
+    wxGCDC dc(gc);   // 析构时把内容写回 image
+
+    // 网格（设备坐标）；画笔画刷都在本线程构造，不复制全局的库存对象
+    const double period = 20.0 * req.scale;
+    const wxColour gridColour(240, 240, 240);
+    dc.SetPen(wxPen(gridColour, std::max(1, static_cast<int>(std::lround(req.scale)))));
+    for (double k = std::ceil(-req.offset.x / period); ; ++k) {
+        const int x = static_cast<int>(std::lround(k * period)) + req.offset.x;
+        if (x >= w) break;
+        dc.DrawLine(x, 0, x, h);
+    }
+    for (double k = std::ceil(-req.offset.y / period); ; ++k) {
+        const int y = static_cast<int>(std::lround(k * period)) + req.offset.y;
+        if (y >= h) break;
+        dc.DrawLine(0, y, w, y);
+    }
+
+    dc.SetDeviceOrigin(req.offset.x, req.offset.y);
+    dc.SetUserScale(req.scale, req.scale);
+    wxRect view(wxPoint(static_cast<int>(std::floor(-req.offset.x / req.scale)),
+                        static_cast<int>(std::floor(-req.offset.y / req.scale))),
+                wxPoint(static_cast<int>(std::ceil((w - req.offset.x) / req.scale)),
+                        static_cast<int>(std::ceil((h - req.offset.y) / req.scale))));
+    view.Inflate(4);
+
+    // 定期检查是否要退出，避免析构时等一整帧
+    size_t n = 0;
+    for (const CanvasElement& e : scene.elements) {
+        if ((++n & 1023) == 0 && abort) return false;
+        if (e.GetBounds().Intersects(view)) e.Draw(dc, req.detail);
+    }
+    WireBatch batch;
+    for (size_t i = 0; i < scene.wires.size(); ++i) {
+        if ((++n & 1023) == 0 && abort) return false;
+        if (scene.wires[i].GetBounds().Intersects(view))
+            batch.Add(scene.wires[i], colours[i]);
+    }
+    batch.Flush(dc, req.detail != DetailLevel::Full ? 1 : 2);
+    return true;
+}
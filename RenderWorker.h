@@ -0,0 +1,88 @@
+﻿#pragma once
+#include <wx/wx.h>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "CanvasElement.h"
+#include "Wire.h"
+#include "SlotMap.h"
+
+// 快照的几何部分：元件和导线的形状。只有导线颜色变化（仿真单步）时新快照沿用同一份
+struct SceneGeometry
+{
+    std::vector<CanvasElement> elements;
+    std::vector<Wire>          wires;
+    std::vector<WireHandle>    wireHandles;       // 与 wires 一一对应，换颜色时按它取值
+    // 不在快照里、由界面线程画在叠加层的内容
+    ElementHandle              selected;          // 生成时选中的元件
+    ElementHandle              floatingElement;   // 拖动中的元件
+    std::vector<WireHandle>    floatingWires;     // 随元件拖动或正在编辑的导线
+    uint64_t sceneVersion = 0;                    // 生成时的静态内容版本
+};
+
+// 后台光栅化用的只读场景快照：由界面线程生成，之后不再修改，可被多个请求共享
+struct SceneSnapshot
+{
+    std::shared_ptr<const SceneGeometry> geometry;
+    std::vector<wxColour> wireColours;   // 与 geometry->wires 一一对应
+    uint64_t colourVersion = 0;
+    uint64_t version = 0;                // 每份快照不同
+};
+
+// 一次光栅化请求：快照 + 视图参数
+struct RenderRequest
+{
+    std::shared_ptr<const SceneSnapshot> scene;
+    float       scale = 1.0f;
+    wxPoint     offset;
+    wxSize      size;
+    DetailLevel detail = DetailLevel::Full;
+};
+
+// 画好的一帧，参数与请求一致
+struct RenderedFrame
+{
+    wxImage  image;
+    float    scale = 0;
+    wxPoint  offset;
+    uint64_t version = 0;
+    std::shared_ptr<const SceneGeometry> geometry;   // 这一帧画的内容，叠加层据此补画帧里没有的部分
+};
+
+/*
+ * 场景光栅化线程：界面线程提交请求，工作线程用 wxGraphicsContext 画进 wxImage
+ * （wxBitmap 只能在界面线程使用，由界面线程转换）
+ * - 只保留最新的一个待处理请求，积压的旧请求直接丢弃
+ * - 画完的帧放进交接缓冲，界面线程 TakeFrame 取走；工作线程在另一块缓冲上画下一帧
+ * - wxImage 的引用计数不是线程安全的，交接一律 swap，两个线程从不共享同一份数据
+ * - onFrameReady 在工作线程调用，只能做线程安全的通知（如 CallAfter）
+ */
+class RenderWorker
+{
+public:
+    explicit RenderWorker(std::function<void()> onFrameReady);
+    ~RenderWorker();
+
+    void Submit(RenderRequest req);
+    bool TakeFrame(RenderedFrame& out);   // 有新帧时换出到 out
+
+    // 在调用线程上画一帧；abort 变为 true 时提前返回 false
+    static bool Rasterize(const RenderRequest& req, RenderedFrame& out, const std::atomic<bool>& abort);
+
+private:
+    void Run();
+
+    std::function<void()> m_onFrameReady;
+    std::mutex              m_mutex;
+    std::condition_variable m_cv;
+    RenderRequest m_pending;
+    bool          m_hasRequest = false;
+    RenderedFrame m_ready;
+    bool          m_hasFrame = false;
+    std::atomic<bool> m_stop{ false };
+    std::thread   m_thread;   // 最后声明：其余成员初始化后再启动
+};
@@ -0,0 +1,582 @@
+﻿#include "Simulator.h"
+#include "my_log.h"
+#include <algorithm>
+#include <utility>
+
+wxColour SimValueColour(SimValue v)
+{
+    // 与 Logisim 的配色保持一致
+    switch (v) {
+    case SimValue::Zero:    return wxColour(0, 100, 0);     // 深绿
+    case SimValue::One:     return wxColour(0, 210, 0);     // 亮绿
+    case SimValue::Unknown: return wxColour(220, 0, 0);     // 红：冲突/未知
+    default:                return wxColour(40, 40, 255);   // 蓝：悬空
+    }
+}
+
+namespace {
+
+SimValue Not(SimValue v)
+{
+    if (v == SimValue::Zero) return SimValue::One;
+    if (v == SimValue::One)  return SimValue::Zero;
+    return SimValue::Unknown;
+}
+
+// 悬空输入视为未连接（与 Logisim 一致），全部悬空时输出未知
+SimValue AndOf(const SimValue* in, uint32_t n)
+{
+    bool unknown = false, any = false;
+    for (uint32_t i = 0; i < n; ++i) {
+        if (in[i] == SimValue::Zero) return SimValue::Zero;
+        if (in[i] == SimValue::Unknown) unknown = true;
+        if (in[i] != SimValue::Floating) any = true;
+    }
+    return (unknown || !any) ? SimValue::Unknown : SimValue::One;
+}
+
+SimValue OrOf(const SimValue* in, uint32_t n)
+{
+    bool unknown = false, any = false;
+    for (uint32_t i = 0; i < n; ++i) {
+        if (in[i] == SimValue::One) return SimValue::One;
+        if (in[i] == SimValue::Unknown) unknown = true;
+        if (in[i] != SimValue::Floating) any = true;
+    }
+    return (unknown || !any) ? SimValue::Unknown : SimValue::Zero;
+}
+
+// 奇校验：高电平个数为奇数时输出 1（两输入时即 XOR）
+SimValue ParityOf(const SimValue* in, uint32_t n)
+{
+    bool odd = false, any = false;
+    for (uint32_t i = 0; i < n; ++i) {
+        if (in[i] == SimValue::Unknown) return SimValue::Unknown;
+        if (in[i] == SimValue::Floating) continue;
+        any = true;
+        if (in[i] == SimValue::One) odd = !odd;
+    }
+    if (!any) return SimValue::Unknown;
+    return odd ? SimValue::One : SimValue::Zero;
+}
+
+} // namespace
+
+Simulator::Simulator()
+    : m_wheel(kWheelSize)
+{
+}
+
+void Simulator::Clear()
+{
+    m_built = false;
+    m_net.Clear();
+    m_netValue.clear();
+    m_slotValue.clear();
+    m_slotScheduled.clear();
+    m_state.clear();
+    for (auto& bucket : m_wheel) bucket.clear();
+    m_current.clear();
+    m_dirty.clear();
+    m_dirtyStamp.clear();
+    m_now = 0;
+    m_pending = 0;
+    m_evalCount = 0;
+    m_levelOrder.clear();
+    m_loops.clear();
+    m_loopOf.clear();
+    m_loopQueue.clear();
+    m_queued.clear();
+    m_levelCount = 0;
+    m_stable = true;
+    m_changedNets.clear();
+    m_changedFlag.clear();
+    m_allChanged = true;
+}
+
+void Simulator::Build(const std::vector<CanvasElement>& elements, const Netlist& netlist)
+{
+    Clear();
+    m_net.Compile(elements, netlist);
+    m_netValue.assign(m_net.NetCount(), SimValue::Floating);
+    m_slotValue.assign(m_net.SlotCount(), SimValue::Floating);
+    m_slotScheduled.assign(m_net.SlotCount(), SimValue::Floating);
+    m_state.assign(m_net.GateCount(), SimValue::Zero);
+    m_dirtyStamp.assign(m_net.GateCount(), 0);
+    m_changedFlag.assign(m_net.NetCount(), 0);
+    Levelize();
+    m_built = true;
+
+    MyLog("Simulator::Build: components=%u nets=%u wires=%zu levels=%zu loops=%zu\n",
+        m_net.GateCount(), m_net.NetCount(), m_net.wireNet.size(), m_levelCount, m_loops.size());
+}
+
+bool Simulator::Update(const std::vector<CanvasElement>& elements, const Netlist& netlist,
+    const std::vector<int>& changedNets)
+{
+    if (!m_built) return false;
+    CompiledNetlist next;
+    next.Compile(elements, netlist);
+
+    // 已有的门下标和输出槽编号必须不变，待处理事件和门的状态才能沿用
+    const uint32_t oldGates = m_net.GateCount();
+    if (next.GateCount() < oldGates) return false;
+    for (uint32_t g = 0; g < oldGates; ++g)
+        if (next.kind[g] != m_net.kind[g] || next.outStart[g + 1] != m_net.outStart[g + 1] ||
+            next.negate[g] != m_net.negate[g]) return false;
+
+    // 删除导线时最后一根搬到空位，编译前后同一下标可能是不同的导线，按值比较找出要重画的
+    std::vector<SimValue> oldWireValue(m_net.wireNet.size());
+    for (size_t w = 0; w < oldWireValue.size(); ++w) oldWireValue[w] = GetWireValue(w);
+
+    m_net = std::move(next);
+    const uint32_t gates = m_net.GateCount();
+    m_slotValue.resize(m_net.SlotCount(), SimValue::Floating);
+    m_slotScheduled.resize(m_net.SlotCount(), SimValue::Floating);
+    m_state.resize(gates, SimValue::Zero);
+    m_dirtyStamp.resize(gates, 0);
+
+    // 网络重新编号了，值由输出槽重新合成：没变的网络驱动者不变，结果与原来相同
+    m_netValue.resize(m_net.NetCount());
+    for (uint32_t n = 0; n < m_net.NetCount(); ++n) m_netValue[n] = ResolveNet(n);
+    if (!m_changedNets.empty()) m_allChanged = true;   // 旧编号下还没重画的变化
+    m_changedNets.clear();
+    m_changedFlag.assign(m_net.NetCount(), 0);
+    for (size_t w = 0; w < m_net.wireNet.size(); ++w)
+        if (w >= oldWireValue.size() || GetWireValue(w) != oldWireValue[w]) NoteChange(m_net.wireNet[w]);
+    Levelize();
+
+    // 变化的网络上的导线换了颜色；读这些网络的门和新增的门重新求值
+    m_dirty.clear();
+    auto mark = [this](uint32_t g) {
+        if (m_queued[g]) return;
+        m_queued[g] = 1;
+        m_dirty.push_back(g);
+        };
+    for (int n : changedNets) {
+        const int dense = m_net.DenseNet(n);
+        if (dense < 0) continue;
+        NoteChange(dense);
+        for (uint32_t k = m_net.readerStart[dense]; k < m_net.readerStart[dense + 1]; ++k) mark(m_net.readers[k]);
+    }
+    for (uint32_t g = oldGates; g < gates; ++g) mark(g);
+    for (uint32_t g : m_dirty) m_queued[g] = 0;
+    // 层次化模式在下一遍里求值全部门
+    if (m_mode == SimMode::EventDriven)
+        for (uint32_t g : m_dirty) Evaluate(g);
+
+    MyLog("Simulator::Update: components=%u nets=%u changed=%zu reseeded=%zu\n",
+        gates, m_net.NetCount(), changedNets.size(), m_dirty.size());
+    return true;
+}
+
+void Simulator::NoteChange(uint32_t net)
+{
+    if (m_allChanged || m_changedFlag[net]) return;
+    // 变化的网络超过一定比例时，逐根重画导线不如整体重画
+    if (m_changedNets.size() >= m_net.NetCount() / 8 + 64) {
+        m_allChanged = true;
+        return;
+    }
+    m_changedFlag[net] = 1;
+    m_changedNets.push_back(net);
+}
+
+bool Simulator::GetChangedWires(std::vector<size_t>& out) const
+{
+    out.clear();
+    if (!m_built || m_allChanged) return false;
+    for (uint32_t n : m_changedNets)
+        for (uint32_t k = m_net.wireStart[n]; k < m_net.wireStart[n + 1]; ++k)
+            out.push_back(m_net.netWires[k]);
+    return true;
+}
+
+void Simulator::ClearValueChanges()
+{
+    for (uint32_t n : m_changedNets) m_changedFlag[n] = 0;
+    m_changedNets.clear();
+    m_allChanged = false;
+}
+
+void Simulator::Levelize()
+{
+    const uint32_t n = m_net.GateCount();
+
+    // 门 -> 门的后继（CSR）：输出网络的全部读者
+    std::vector<uint32_t> succStart(n + 1), succ;
+    for (uint32_t g = 0; g < n; ++g) {
+        succStart[g] = static_cast<uint32_t>(succ.size());
+        for (uint32_t slot = m_net.outStart[g]; slot < m_net.outStart[g + 1]; ++slot) {
+            const uint32_t net = m_net.slotNet[slot];
+            for (uint32_t k = m_net.readerStart[net]; k < m_net.readerStart[net + 1]; ++k)
+                succ.push_back(m_net.readers[k]);
+        }
+    }
+    succStart[n] = static_cast<uint32_t>(succ.size());
+
+    // Tarjan 强连通分量（显式栈，避免大电路递归过深）；分量按逆拓扑序产生
+    const uint32_t kNone = UINT32_MAX;
+    std::vector<uint32_t> index(n, kNone), low(n), stack;
+    std::vector<uint8_t> onStack(n, 0);
+    std::vector<uint32_t> members, compStart;       // 分量成员依次排放
+    std::vector<std::pair<uint32_t, uint32_t>> call;  // (门, 下一条出边)
+    uint32_t counter = 0;
+    for (uint32_t root = 0; root < n; ++root) {
+        if (index[root] != kNone) continue;
+        index[root] = low[root] = counter++;
+        stack.push_back(root);
+        onStack[root] = 1;
+        call.push_back({ root, succStart[root] });
+        while (!call.empty()) {
+            const uint32_t g = call.back().first;
+            uint32_t& e = call.back().second;
+            if (e < succStart[g + 1]) {
+                const uint32_t s = succ[e++];
+                if (index[s] == kNone) {
+                    index[s] = low[s] = counter++;
+                    stack.push_back(s);
+                    onStack[s] = 1;
+                    call.push_back({ s, succStart[s] });
+                }
+                else if (onStack[s]) {
+                    low[g] = std::min(low[g], index[s]);
+                }
+                continue;
+            }
+            if (low[g] == index[g]) {
+                compStart.push_back(static_cast<uint32_t>(members.size()));
+                uint32_t x;
+                do {
+                    x = stack.back();
+                    stack.pop_back();
+                    onStack[x] = 0;
+                    members.push_back(x);
+                } while (x != g);
+            }
+            call.pop_back();
+            if (!call.empty()) {
+                const uint32_t parent = call.back().first;
+                low[parent] = std::min(low[parent], low[g]);
+            }
+        }
+    }
+    compStart.push_back(static_cast<uint32_t>(members.size()));
+
+    // 逆序输出即拓扑序；多于一个门或有自环的分量记为反馈环
+    m_levelOrder.clear();
+    m_levelOrder.reserve(n);
+    m_loops.clear();
+    m_loopOf.assign(n, kNone);
+    std::vector<uint32_t> compOf(n);
+    const uint32_t comps = static_cast<uint32_t>(compStart.size() - 1);
+    for (uint32_t c = comps; c-- > 0;) {
+        const uint32_t first = compStart[c], last = compStart[c + 1];
+        bool loop = last - first > 1;
+        if (!loop) {
+            const uint32_t g = members[first];
+            loop = std::find(succ.begin() + succStart[g], succ.begin() + succStart[g + 1], g) != succ.begin() + succStart[g + 1];
+        }
+        if (loop) m_loops.push_back({ static_cast<uint32_t>(m_levelOrder.size()), last - first });
+        for (uint32_t k = first; k < last; ++k) {
+            compOf[members[k]] = c;
+            if (loop) m_loopOf[members[k]] = static_cast<uint32_t>(m_loops.size() - 1);
+            m_levelOrder.push_back(members[k]);
+        }
+    }
+
+    // 逻辑深度：按拓扑序向后继传递层号，同一分量取同一层
+    std::vector<uint32_t> level(n, 0);
+    uint32_t maxLevel = 0;
+    for (size_t pos = 0; pos < m_levelOrder.size();) {
+        const uint32_t c = compOf[m_levelOrder[pos]];
+        size_t end = pos;
+        uint32_t lv = 0;
+        while (end < m_levelOrder.size() && compOf[m_levelOrder[end]] == c)
+            lv = std::max(lv, level[m_levelOrder[end++]]);
+        maxLevel = std::max(maxLevel, lv);
+        for (; pos < end; ++pos) {
+            const uint32_t g = m_levelOrder[pos];
+            for (uint32_t k = succStart[g]; k < succStart[g + 1]; ++k)
+                if (compOf[succ[k]] != c) level[succ[k]] = std::max(level[succ[k]], lv + 1);
+        }
+    }
+    m_levelCount = n ? maxLevel + 1 : 0;
+    m_queued.assign(n, 0);
+}
+
+size_t Simulator::GetLoopGateCount() const
+{
+    size_t total = 0;
+    for (const Loop& loop : m_loops) total += loop.count;
+    return total;
+}
+
+void Simulator::Reset()
+{
+    if (!m_built) return;
+
+    for (auto& bucket : m_wheel) bucket.clear();
+    m_pending = 0;
+    m_now = 0;
+    m_evalCount = 0;
+    std::fill(m_slotValue.begin(), m_slotValue.end(), SimValue::Floating);
+    std::fill(m_slotScheduled.begin(), m_slotScheduled.end(), SimValue::Floating);
+    std::fill(m_dirtyStamp.begin(), m_dirtyStamp.end(), 0);
+    std::fill(m_netValue.begin(), m_netValue.end(), SimValue::Floating);
+    std::fill(m_state.begin(), m_state.end(), SimValue::Zero);
+    m_stable = true;
+    m_allChanged = true;
+
+    // 初始状态需要对所有元件求值一次，此后只做增量求值；层次化模式在每一遍里求值
+    if (m_mode == SimMode::Levelized) return;
+    for (uint32_t g = 0; g < m_net.GateCount(); ++g)
+        Evaluate(g);
+}
+
+void Simulator::Schedule(uint32_t slot, SimValue v, uint32_t delay)
+{
+    if (delay >= kWheelSize) delay = kWheelSize - 1;
+    m_wheel[(m_now + delay) & (kWheelSize - 1)].push_back({ slot, v });
+    m_slotScheduled[slot] = v;
+    ++m_pending;
+}
+
+SimValue Simulator::ResolveNet(uint32_t net) const
+{
+    SimValue v = SimValue::Floating;
+    for (uint32_t d = m_net.driverStart[net]; d < m_net.driverStart[net + 1]; ++d) {
+        SimValue x = m_slotValue[m_net.drivers[d]];
+        if (x == SimValue::Floating) continue;
+        if (v == SimValue::Floating) v = x;
+        else if (v != x) return SimValue::Unknown;   // 多驱动冲突
+    }
+    return v;
+}
+
+SimValue Simulator::Compute(uint32_t gate) const
+{
+    const GateKind kind = m_net.kind[gate];
+
+    // 门的输入最多只有几个，放在栈上
+    SimValue in[8];
+    const uint32_t first = m_net.inStart[gate];
+    const uint32_t n = std::min<uint32_t>(m_net.inStart[gate + 1] - first, 8);
+    for (uint32_t i = 0; i < n; ++i) in[i] = m_netValue[m_net.inNet[first + i]];
+    // 取反的输入（Negate N）：悬空仍视为未连接
+    if (const uint8_t neg = m_net.negate[gate]) {
+        for (uint32_t i = 0; i < n; ++i)
+            if (((neg >> i) & 1) && (in[i] == SimValue::Zero || in[i] == SimValue::One)) in[i] = Not(in[i]);
+    }
+
+    SimValue out = SimValue::Unknown;
+    switch (kind) {
+    case GateKind::Buffer:     out = n ? (in[0] == SimValue::Floating ? SimValue::Unknown : in[0]) : out; break;
+    case GateKind::Not:        out = n ? Not(in[0]) : out; break;
+    case GateKind::And:        out = AndOf(in, n); break;
+    case GateKind::Nand:       out = Not(AndOf(in, n)); break;
+    case GateKind::Or:         out = OrOf(in, n); break;
+    case GateKind::Nor:        out = Not(OrOf(in, n)); break;
+    case GateKind::Xor:
+    case GateKind::OddParity:  out = ParityOf(in, n); break;
+    case GateKind::Xnor:
+    case GateKind::EvenParity: out = Not(ParityOf(in, n)); break;
+    case GateKind::ControlledBuffer:
+    case GateKind::ControlledInverter:
+        if (n >= 2) {
+            SimValue data = kind == GateKind::ControlledInverter ? Not(in[0]) : in[0];
+            if (in[1] == SimValue::One) out = data == SimValue::Floating ? SimValue::Unknown : data;
+            else if (in[1] == SimValue::Zero) out = SimValue::Floating;
+        }
+        break;
+    case GateKind::Passthrough:  out = n ? in[0] : SimValue::Floating; break;
+    case GateKind::PullResistor: out = (n && in[0] != SimValue::Floating) ? in[0] : SimValue::Zero; break;
+    case GateKind::Source:
+    case GateKind::Clock:      out = m_state[gate]; break;
+    case GateKind::Constant:
+    case GateKind::Power:      out = SimValue::One; break;
+    case GateKind::Ground:     out = SimValue::Zero; break;
+    case GateKind::Sink:
+    case GateKind::Unsupported:
+        break;
+    }
+
+    return out;
+}
+
+void Simulator::Evaluate(uint32_t gate)
+{
+    ++m_evalCount;
+    const SimValue out = Compute(gate);
+    for (uint32_t slot = m_net.outStart[gate]; slot < m_net.outStart[gate + 1]; ++slot) {
+        if (m_slotScheduled[slot] != out)
+            Schedule(slot, out, m_net.delay[gate]);
+    }
+}
+
+bool Simulator::Drive(uint32_t gate, SimValue out)
+{
+    bool changed = false;
+    for (uint32_t slot = m_net.outStart[gate]; slot < m_net.outStart[gate + 1]; ++slot) {
+        if (m_slotValue[slot] == out) continue;
+        m_slotValue[slot] = out;
+        m_slotScheduled[slot] = out;
+        const uint32_t net = m_net.slotNet[slot];
+        const SimValue v = ResolveNet(net);
+        if (v == m_netValue[net]) continue;
+        m_netValue[net] = v;
+        NoteChange(net);
+        changed = true;
+    }
+    return changed;
+}
+
+// 反馈环内零延迟迭代：只重新求值输入发生变化的环内成员
+bool Simulator::SolveLoop(uint32_t loop)
+{
+    const Loop& l = m_loops[loop];
+    m_loopQueue.clear();
+    for (uint32_t k = l.first; k < l.first + l.count; ++k) {
+        m_loopQueue.push_back(m_levelOrder[k]);
+        m_queued[m_levelOrder[k]] = 1;
+    }
+    const size_t budget = kLoopEvalsPerGate * l.count;
+    size_t head = 0;
+    for (; head < m_loopQueue.size() && head < budget; ++head) {
+        const uint32_t g = m_loopQueue[head];
+        m_queued[g] = 0;
+        ++m_evalCount;
+        if (!Drive(g, Compute(g))) continue;
+        for (uint32_t slot = m_net.outStart[g]; slot < m_net.outStart[g + 1]; ++slot) {
+            const uint32_t net = m_net.slotNet[slot];
+            for (uint32_t k = m_net.readerStart[net]; k < m_net.readerStart[net + 1]; ++k) {
+                const uint32_t r = m_net.readers[k];
+                if (m_loopOf[r] == loop && !m_queued[r]) {
+                    m_queued[r] = 1;
+                    m_loopQueue.push_back(r);
+                }
+            }
+        }
+    }
+    if (head == m_loopQueue.size()) return true;
+    for (; head < m_loopQueue.size(); ++head) m_queued[m_loopQueue[head]] = 0;
+    return false;
+}
+
+// 按拓扑序把全部门求值一遍：环外的门直通求值，遇到反馈环就地迭代
+size_t Simulator::EvaluateLevelized()
+{
+    const size_t before = m_evalCount;
+    const size_t n = m_levelOrder.size();
+    m_stable = true;
+    size_t pos = 0;
+    for (uint32_t loop = 0; loop <= m_loops.size(); ++loop) {
+        const size_t end = loop < m_loops.size() ? m_loops[loop].first : n;
+        m_evalCount += end - pos;
+        for (; pos < end; ++pos) {
+            const uint32_t g = m_levelOrder[pos];
+            Drive(g, Compute(g));
+        }
+        if (loop == m_loops.size()) break;
+        if (!SolveLoop(loop)) m_stable = false;
+        pos += m_loops[loop].count;
+    }
+    ++m_now;
+    return m_evalCount - before;
+}
+
+size_t Simulator::Step()
+{
+    if (m_built && m_mode == SimMode::Levelized) return EvaluateLevelized();
+    if (!m_built || m_pending == 0) return 0;
+
+    // 跳过空桶；所有延迟都小于轮长，因此最多转一圈
+    while (m_wheel[m_now & (kWheelSize - 1)].empty()) ++m_now;
+
+    m_current.clear();
+    m_current.swap(m_wheel[m_now & (kWheelSize - 1)]);
+    m_pending -= m_current.size();
+
+    // 1. 应用事件，记录输入发生变化的元件
+    const uint64_t stamp = m_now + 1;
+    m_dirty.clear();
+    for (const SimEvent& e : m_current) {
+        if (m_slotValue[e.slot] == e.value) continue;
+        m_slotValue[e.slot] = e.value;
+
+        const uint32_t net = m_net.slotNet[e.slot];
+        SimValue v = ResolveNet(net);
+        if (v == m_netValue[net]) continue;
+        m_netValue[net] = v;
+        NoteChange(net);
+        for (uint32_t k = m_net.readerStart[net]; k < m_net.readerStart[net + 1]; ++k) {
+            const uint32_t r = m_net.readers[k];
+            if (m_dirtyStamp[r] != stamp) {
+                m_dirtyStamp[r] = stamp;
+                m_dirty.push_back(r);
+            }
+        }
+    }
+
+    // 2. 只对受影响的元件求值，新事件落在后续时间片
+    for (uint32_t ci : m_dirty) Evaluate(ci);
+
+    ++m_now;
+    return m_current.size();
+}
+
+bool Simulator::Propagate(size_t maxSteps)
+{
+    if (m_built && m_mode == SimMode::Levelized) {
+        EvaluateLevelized();
+        if (!m_stable) MyLog("Simulator::Propagate: feedback loop did not settle (oscillation?)\n");
+        return m_stable;
+    }
+    for (size_t i = 0; i < maxSteps; ++i) {
+        if (m_pending == 0) return true;
+        Step();
+    }
+    MyLog("Simulator::Propagate: not stable after %zu steps (oscillation?)\n", maxSteps);
+    return m_pending == 0;
+}
+
+void Simulator::Tick()
+{
+    if (!m_built) return;
+    for (uint32_t g = 0; g < m_net.GateCount(); ++g) {
+        if (m_net.kind[g] != GateKind::Clock) continue;
+        m_state[g] = m_state[g] == SimValue::One ? SimValue::Zero : SimValue::One;
+        if (m_mode == SimMode::Levelized) continue;   // 下一遍求值时生效
+        for (uint32_t slot = m_net.outStart[g]; slot < m_net.outStart[g + 1]; ++slot)
+            Schedule(slot, m_state[g], 0);
+    }
+}
+
+bool Simulator::SetSourceValue(size_t elemIdx, SimValue v)
+{
+    if (!m_built || elemIdx >= m_net.GateCount()) return false;
+    if (m_net.kind[elemIdx] != GateKind::Source) return false;
+    m_state[elemIdx] = v;
+    if (m_mode == SimMode::Levelized) return true;
+    for (uint32_t slot = m_net.outStart[elemIdx]; slot < m_net.outStart[elemIdx + 1]; ++slot)
+        if (m_slotScheduled[slot] != v)
+            Schedule(slot, v, 0);
+    return true;
+}
+
+SimValue Simulator::GetWireValue(size_t wireIdx) const
+{
+    if (wireIdx >= m_net.wireNet.size() || m_net.wireNet[wireIdx] < 0) return SimValue::Floating;
+    return m_netValue[m_net.wireNet[wireIdx]];
+}
+
+SimValue Simulator::GetPinValue(size_t elemIdx, bool isInput, size_t pinIdx) const
+{
+    if (elemIdx >= m_net.GateCount()) return SimValue::Floating;
+    if (isInput) {
+        const uint32_t first = m_net.inStart[elemIdx];
+        return pinIdx < m_net.inStart[elemIdx + 1] - first ? m_netValue[m_net.inNet[first + pinIdx]] : SimValue::Floating;
+    }
+    const uint32_t first = m_net.outStart[elemIdx];
+    return pinIdx < m_net.outStart[elemIdx + 1] - first ? m_netValue[m_net.slotNet[first + pinIdx]] : SimValue::Floating;
+}
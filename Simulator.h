@@ -0,0 +1,131 @@
+﻿#pragma once
+#include <wx/wx.h>
+#include <vector>
+#include <cstdint>
+#include "CanvasElement.h"
+#include "Wire.h"
+#include "Netlist.h"
+#include "CompiledNetlist.h"
+
+// 信号值：低 / 高 / 未知（冲突或未初始化）/ 悬空（无驱动）
+enum class SimValue : uint8_t { Zero, One, Unknown, Floating };
+
+wxColour SimValueColour(SimValue v);   // 导线按信号值着色
+
+// 求值方式：事件驱动（按延迟排进时间轮）或层次化（按拓扑序一遍求值，没有事件队列）
+enum class SimMode : uint8_t { EventDriven, Levelized };
+
+/*
+ * 事件驱动的门级仿真器
+ * - 拓扑来自 CompiledNetlist 的扁平数组；网络值、输出槽值各占一块连续缓冲
+ * - 时间轮（timing wheel）保存未来事件，每个时间片一个桶
+ * - 只有输入网络发生变化的元件才会被重新求值
+ *
+ * 层次化模式：构建时把门按扇出关系求强连通分量并拓扑排序，
+ * Step 按这个顺序把所有门求值一遍，不使用时间轮，适合大块组合逻辑；
+ * 反馈环（多于一个门的强连通分量或自环）在该处就地做零延迟的事件迭代直到稳定，
+ * 超出迭代预算视为振荡
+ */
+class Simulator
+{
+public:
+    Simulator();
+
+    // 从画布元件和网表重建仿真模型（清空全部状态，需要再调用 Reset）
+    void Build(const std::vector<CanvasElement>& elements, const Netlist& netlist);
+    void Clear();
+
+    // 增量更新：网表只有追加元件、改动导线、移动元件这类修改时，重新编译拓扑但保留信号值、
+    // 内部状态和待处理事件，只重新求值接在 changedNets（网表编号）上的门和新增的门；
+    // 已有元件的类型或引脚数对不上时返回 false，调用方改用 Build + Reset
+    bool Update(const std::vector<CanvasElement>& elements, const Netlist& netlist,
+        const std::vector<int>& changedNets);
+
+    void    SetMode(SimMode mode) { m_mode = mode; }   // 切换后需要 Reset
+    SimMode GetMode() const { return m_mode; }
+
+    void   Reset();                          // 回到初始状态并做一次全量初始求值
+    size_t Step();                           // 处理下一个非空时间片，返回处理的事件数；层次化模式下求值一遍，返回求值次数
+    bool   Propagate(size_t maxSteps = 10000); // 推进到稳定；超出步数视为振荡，返回 false
+    void   Tick();                           // 翻转全部时钟
+    bool   SetSourceValue(size_t elemIdx, SimValue v);
+
+    bool     IsBuilt() const { return m_built; }
+    uint64_t GetTime() const { return m_now; }
+    size_t   GetPendingEvents() const { return m_pending; }
+    size_t   GetEvaluationCount() const { return m_evalCount; }
+    size_t   GetNetCount() const { return m_net.NetCount(); }
+    size_t   GetComponentCount() const { return m_net.GateCount(); }
+    size_t   GetWireCount() const { return m_net.wireNet.size(); }
+    const CompiledNetlist& GetCompiled() const { return m_net; }
+
+    // 层次化分析结果（Build 时计算）
+    size_t GetLevelCount() const { return m_levelCount; }     // 逻辑深度，反馈环整体算一层
+    size_t GetLoopCount() const { return m_loops.size(); }
+    size_t GetLoopGateCount() const;
+    const std::vector<uint32_t>& GetLevelOrder() const { return m_levelOrder; }   // 拓扑序
+
+    SimValue GetWireValue(size_t wireIdx) const;
+    SimValue GetPinValue(size_t elemIdx, bool isInput, size_t pinIdx) const;
+
+    // 自上次 ClearValueChanges() 以来所在网络的值变化过的导线，供画布只重画这些导线；
+    // 重建过或变化的网络太多时返回 false，表示整体重画
+    bool GetChangedWires(std::vector<size_t>& out) const;
+    void ClearValueChanges();
+
+private:
+    struct SimEvent {
+        uint32_t slot;     // 输出槽
+        SimValue value;
+    };
+
+    // 反馈环：m_levelOrder 中连续的一段
+    struct Loop {
+        uint32_t first;
+        uint32_t count;
+    };
+
+    static const size_t kWheelSize = 256;   // 必须是 2 的幂，延迟不超过 kWheelSize-1
+    static const size_t kLoopEvalsPerGate = 64;   // 反馈环迭代预算
+
+    void     Schedule(uint32_t slot, SimValue v, uint32_t delay);
+    void     Evaluate(uint32_t gate);
+    SimValue Compute(uint32_t gate) const;
+    SimValue ResolveNet(uint32_t net) const;
+
+    void     Levelize();
+    size_t   EvaluateLevelized();
+    bool     SolveLoop(uint32_t loop);
+    bool     Drive(uint32_t gate, SimValue out);   // 立即写输出槽并更新网络，返回是否有网络变化
+    void     NoteChange(uint32_t net);
+
+    bool m_built = false;
+    SimMode m_mode = SimMode::EventDriven;
+    CompiledNetlist           m_net;
+    std::vector<SimValue>     m_netValue;       // 网络 -> 当前值
+    std::vector<SimValue>     m_slotValue;      // 输出槽当前值
+    std::vector<SimValue>     m_slotScheduled;  // 输出槽在全部待处理事件生效后的值
+    std::vector<SimValue>     m_state;          // Source / Clock 的内部状态
+
+    std::vector<std::vector<SimEvent>> m_wheel;
+    std::vector<SimEvent>     m_current;        // 当前时间片的事件（复用容量）
+    std::vector<uint32_t>     m_dirty;          // 本时间片需要重新求值的元件
+    std::vector<uint64_t>     m_dirtyStamp;     // 去重标记
+    uint64_t m_now = 0;
+    size_t   m_pending = 0;
+    size_t   m_evalCount = 0;
+
+    // 层次化模式
+    std::vector<uint32_t>     m_levelOrder;     // 拓扑序，反馈环的成员排在一起
+    std::vector<Loop>         m_loops;          // 按在 m_levelOrder 中的位置排序
+    std::vector<uint32_t>     m_loopOf;         // 门 -> 所在反馈环，不在环中为 UINT32_MAX
+    std::vector<uint32_t>     m_loopQueue;
+    std::vector<uint8_t>      m_queued;
+    size_t   m_levelCount = 0;
+    bool     m_stable = true;                   // 上一遍层次化求值是否全部收敛
+
+    // 值变化过的网络
+    std::vector<uint32_t>     m_changedNets;
+    std::vector<uint8_t>      m_changedFlag;
+    bool     m_allChanged = true;
+};
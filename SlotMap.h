@@ -0,0 +1,140 @@
+﻿#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <utility>
+
+/*
+ * 句柄：槽位号 + 代数。对象删除后槽位代数加一，旧句柄随之失效，
+ * 不会误指向之后复用同一槽位的新对象
+ */
+struct SlotHandle
+{
+    static constexpr uint32_t kNone = 0xFFFFFFFFu;
+    uint32_t slot = kNone;
+    uint32_t gen = 0;
+
+    bool IsNull() const { return slot == kNone; }
+    bool operator==(const SlotHandle& o) const { return slot == o.slot && gen == o.gen; }
+    bool operator!=(const SlotHandle& o) const { return !(*this == o); }
+};
+
+using ElementHandle = SlotHandle;
+using WireHandle = SlotHandle;
+
+/*
+ * 稠密槽位表（slot map）：
+ * - 对象连续存放，可像 vector 一样按下标遍历
+ * - Insert/Erase/句柄查找都是 O(1)
+ * - Erase 把最后一个对象搬到被删位置（与 swap-and-pop 相同），
+ *   按下标索引的附属结构（网表、网格索引）应按同样方式处理
+ * 下标只在两次修改之间有效，需要长期引用对象时保存句柄
+ */
+template <class T>
+class SlotMap
+{
+public:
+    SlotHandle Insert(T value)
+    {
+        uint32_t slot;
+        if (m_freeHead != SlotHandle::kNone) {
+            slot = m_freeHead;
+            m_freeHead = m_slots[slot].index;
+        }
+        else {
+            slot = static_cast<uint32_t>(m_slots.size());
+            m_slots.push_back({ 0, 0 });
+        }
+        m_slots[slot].index = static_cast<uint32_t>(m_values.size());
+        m_values.push_back(std::move(value));
+        m_denseSlot.push_back(slot);
+        return { slot, m_slots[slot].gen };
+    }
+
+    // 删除下标 idx 处的对象，原最后一个对象移到 idx
+    void EraseAt(size_t idx)
+    {
+        const uint32_t slot = m_denseSlot[idx];
+        const size_t last = m_values.size() - 1;
+        if (idx != last) {
+            m_values[idx] = std::move(m_values[last]);
+            m_denseSlot[idx] = m_denseSlot[last];
+            m_slots[m_denseSlot[idx]].index = static_cast<uint32_t>(idx);
+        }
+        m_values.pop_back();
+        m_denseSlot.pop_back();
+
+        ++m_slots[slot].gen;
+        m_slots[slot].index = m_freeHead;
+        m_freeHead = slot;
+    }
+
+    bool Erase(SlotHandle h)
+    {
+        int idx = IndexOf(h);
+        if (idx < 0) return false;
+        EraseAt(static_cast<size_t>(idx));
+        return true;
+    }
+
+    // 句柄对应的当前下标，失效句柄返回 -1
+    int IndexOf(SlotHandle h) const
+    {
+        if (h.slot >= m_slots.size() || m_slots[h.slot].gen != h.gen) return -1;
+        return static_cast<int>(m_slots[h.slot].index);
+    }
+    bool Contains(SlotHandle h) const { return IndexOf(h) >= 0; }
+    SlotHandle HandleAt(size_t idx) const
+    {
+        const uint32_t slot = m_denseSlot[idx];
+        return { slot, m_slots[slot].gen };
+    }
+
+    T* Get(SlotHandle h)
+    {
+        int idx = IndexOf(h);
+        return idx < 0 ? nullptr : &m_values[idx];
+    }
+    const T* Get(SlotHandle h) const
+    {
+        int idx = IndexOf(h);
+        return idx < 0 ? nullptr : &m_values[idx];
+    }
+
+    void clear()
+    {
+        // 保留槽位代数，清空前发出的句柄仍然失效
+        for (uint32_t slot : m_denseSlot) {
+            ++m_slots[slot].gen;
+            m_slots[slot].index = m_freeHead;
+            m_freeHead = slot;
+        }
+        m_values.clear();
+        m_denseSlot.clear();
+    }
+
+    const std::vector<T>& Values() const { return m_values; }
+
+    // vector 风格的访问，按当前下标
+    size_t size() const { return m_values.size(); }
+    bool empty() const { return m_values.empty(); }
+    T& operator[](size_t idx) { return m_values[idx]; }
+    const T& operator[](size_t idx) const { return m_values[idx]; }
+    T& back() { return m_values.back(); }
+    const T& back() const { return m_values.back(); }
+    typename std::vector<T>::iterator begin() { return m_values.begin(); }
+    typename std::vector<T>::iterator end() { return m_values.end(); }
+    typename std::vector<T>::const_iterator begin() const { return m_values.begin(); }
+    typename std::vector<T>::const_iterator end() const { return m_values.end(); }
+
+private:
+    struct Slot {
+        uint32_t index;   // 在用：对象下标；空闲：下一个空闲槽位
+        uint32_t gen;
+    };
+
+    std::vector<T>        m_values;
+    std::vector<uint32_t> m_denseSlot;   // 下标 -> 槽位
+    std::vector<Slot>     m_slots;
+    uint32_t              m_freeHead = SlotHandle::kNone;
+};
@@ -0,0 +1,419 @@
+﻿#include "SpatialHash.h"
+#include <algorithm>
+
+void SpatialHash::Clear()
+{
+    m_cells.clear();
+    m_bounds.clear();
+    m_ranges.clear();
+}
+
+int SpatialHash::CellOf(int v) const
+{
+    return v >= 0 ? v / m_cellSize : -((-v + m_cellSize - 1) / m_cellSize);
+}
+
+SpatialHash::CellRange SpatialHash::RangeOf(const wxRect& r) const
+{
+    // wxRect 的 GetRight/GetBottom 是闭区间
+    return { CellOf(r.GetLeft()), CellOf(r.GetTop()), CellOf(r.GetRight()), CellOf(r.GetBottom()) };
+}
+
+void SpatialHash::Link(uint32_t idx, const CellRange& range)
+{
+    for (int cx = range.x0; cx <= range.x1; ++cx)
+        for (int cy = range.y0; cy <= range.y1; ++cy)
+            m_cells[Key(cx, cy)].push_back(idx);
+}
+
+void SpatialHash::Unlink(uint32_t idx, const CellRange& range)
+{
+    for (int cx = range.x0; cx <= range.x1; ++cx)
+        for (int cy = range.y0; cy <= range.y1; ++cy) {
+            auto it = m_cells.find(Key(cx, cy));
+            if (it == m_cells.end()) continue;
+            auto& list = it->second;
+            auto pos = std::find(list.begin(), list.end(), idx);
+            if (pos != list.end()) {
+                *pos = list.back();
+                list.pop_back();
+            }
+            if (list.empty()) m_cells.erase(it);
+        }
+}
+
+void SpatialHash::Insert(size_t idx, const wxRect& bounds)
+{
+    wxASSERT(idx == m_bounds.size());
+    CellRange range = RangeOf(bounds);
+    m_bounds.push_back(bounds);
+    m_ranges.push_back(range);
+    Link(static_cast<uint32_t>(idx), range);
+}
+
+void SpatialHash::Update(size_t idx, const wxRect& bounds)
+{
+    if (idx >= m_bounds.size()) return;
+    CellRange range = RangeOf(bounds);
+    const CellRange& old = m_ranges[idx];
+    if (old.x0 != range.x0 || old.y0 != range.y0 || old.x1 != range.x1 || old.y1 != range.y1) {
+        Unlink(static_cast<uint32_t>(idx), old);
+        Link(static_cast<uint32_t>(idx), range);
+        m_ranges[idx] = range;
+    }
+    m_bounds[idx] = bounds;
+}
+
+void SpatialHash::Remove(size_t idx)
+{
+    if (idx >= m_bounds.size()) return;
+    Unlink(static_cast<uint32_t>(idx), m_ranges[idx]);
+
+    // 最后一个对象改用 idx 编号，只需改写它所在的格子
+    const size_t last = m_bounds.size() - 1;
+    if (idx != last) {
+        const CellRange& range = m_ranges[last];
+        for (int cx = range.x0; cx <= range.x1; ++cx)
+            for (int cy = range.y0; cy <= range.y1; ++cy)
+                for (auto& i : m_cells[Key(cx, cy)])
+                    if (i == last) i = static_cast<uint32_t>(idx);
+        m_bounds[idx] = m_bounds[last];
+        m_ranges[idx] = range;
+    }
+    m_bounds.pop_back();
+    m_ranges.pop_back();
+}
+
+int SpatialHash::HitTest(const wxPoint& pt) const
+{
+    auto it = m_cells.find(Key(CellOf(pt.x), CellOf(pt.y)));
+    if (it == m_cells.end()) return -1;
+
+    int best = -1;
+    for (uint32_t idx : it->second) {
+        if ((best == -1 || static_cast<int>(idx) < best) && m_bounds[idx].Contains(pt))
+            best = static_cast<int>(idx);
+    }
+    return best;
+}
+
+void SpatialHash::Query(const wxRect& area, std::vector<size_t>& out) const
+{
+    out.clear();
+    CellRange range = RangeOf(area);
+    // 区域覆盖的格子比对象还多时，直接扫描全部包围盒更快
+    const int64_t cells = int64_t(range.x1 - range.x0 + 1) * (range.y1 - range.y0 + 1);
+    if (cells > static_cast<int64_t>(m_cells.size())) {
+        for (size_t i = 0; i < m_bounds.size(); ++i)
+            if (m_bounds[i].Intersects(area)) out.push_back(i);
+        return;
+    }
+    for (int cx = range.x0; cx <= range.x1; ++cx)
+        for (int cy = range.y0; cy <= range.y1; ++cy) {
+            auto it = m_cells.find(Key(cx, cy));
+            if (it == m_cells.end()) continue;
+            for (uint32_t idx : it->second)
+                if (m_bounds[idx].Intersects(area)) out.push_back(idx);
+        }
+    std::sort(out.begin(), out.end());
+    out.erase(std::unique(out.begin(), out.end()), out.end());
+}
+
+//================= 导线线段索引 =================
+template <class Fn>
+void SegmentIndex::ForEachCell(const wxPoint& a, const wxPoint& b, Fn fn) const
+{
+    // 水平/竖直线段的包围盒就是它经过的格子；斜线段取包围盒，偏保守
+    const int x0 = CellOf(std::min(a.x, b.x)), x1 = CellOf(std::max(a.x, b.x));
+    const int y0 = CellOf(std::min(a.y, b.y)), y1 = CellOf(std::max(a.y, b.y));
+    for (int cx = x0; cx <= x1; ++cx)
+        for (int cy = y0; cy <= y1; ++cy)
+            fn(Key(cx, cy));
+}
+
+void SegmentIndex::Clear()
+{
+    m_cells.clear();
+    m_wirePts.clear();
+}
+
+void SegmentIndex::Link(uint32_t wireIdx)
+{
+    const auto& pts = m_wirePts[wireIdx];
+    for (uint32_t s = 0; s + 1 < pts.size(); ++s)
+        ForEachCell(pts[s], pts[s + 1], [&](uint64_t key) {
+            m_cells[key].push_back({ wireIdx, s });
+            });
+}
+
+void SegmentIndex::Unlink(uint32_t wireIdx)
+{
+    const auto& pts = m_wirePts[wireIdx];
+    for (uint32_t s = 0; s + 1 < pts.size(); ++s)
+        ForEachCell(pts[s], pts[s + 1], [&](uint64_t key) {
+            auto it = m_cells.find(key);
+            if (it == m_cells.end()) return;
+            auto& list = it->second;
+            for (size_t i = 0; i < list.size(); ++i) {
+                if (list[i].wire == wireIdx && list[i].seg == s) {
+                    list[i] = list.back();
+                    list.pop_back();
+                    break;
+                }
+            }
+            if (list.empty()) m_cells.erase(it);
+            });
+}
+
+void SegmentIndex::Insert(size_t wireIdx, const Wire& wire)
+{
+    wxASSERT(wireIdx == m_wirePts.size());
+    m_wirePts.emplace_back();
+    Update(wireIdx, wire);
+}
+
+void SegmentIndex::Update(size_t wireIdx, const Wire& wire)
+{
+    if (wireIdx >= m_wirePts.size()) return;
+    Unlink(static_cast<uint32_t>(wireIdx));
+    auto& pts = m_wirePts[wireIdx];
+    pts.clear();
+    pts.reserve(wire.pts.size());
+    for (const auto& cp : wire.pts) pts.push_back(cp.pos);
+    Link(static_cast<uint32_t>(wireIdx));
+}
+
+void SegmentIndex::Remove(size_t wireIdx)
+{
+    if (wireIdx >= m_wirePts.size()) return;
+    Unlink(static_cast<uint32_t>(wireIdx));
+
+    // 最后一根导线改用 wireIdx 编号
+    const uint32_t last = static_cast<uint32_t>(m_wirePts.size() - 1);
+    if (wireIdx != last) {
+        const auto& pts = m_wirePts[last];
+        for (uint32_t s = 0; s + 1 < pts.size(); ++s)
+            ForEachCell(pts[s], pts[s + 1], [&](uint64_t key) {
+                for (auto& ref : m_cells[key])
+                    if (ref.wire == last) ref.wire = static_cast<uint32_t>(wireIdx);
+                });
+        m_wirePts[wireIdx] = std::move(m_wirePts[last]);
+    }
+    m_wirePts.pop_back();
+}
+
+bool SegmentIndex::HitTest(const wxPoint& pt, int tolerance, Hit* hit) const
+{
+    Hit best;
+    best.dist = tolerance;
+    const int x0 = CellOf(pt.x - tolerance), x1 = CellOf(pt.x + tolerance);
+    const int y0 = CellOf(pt.y - tolerance), y1 = CellOf(pt.y + tolerance);
+    for (int cx = x0; cx <= x1; ++cx)
+        for (int cy = y0; cy <= y1; ++cy) {
+            auto it = m_cells.find(Key(cx, cy));
+            if (it == m_cells.end()) continue;
+            for (const SegRef& ref : it->second) {
+                const auto& pts = m_wirePts[ref.wire];
+                wxPoint closest;
+                double d = Wire::DistanceToSegment(pt, pts[ref.seg], pts[ref.seg + 1], &closest);
+                if (d > best.dist) continue;
+                if (d == best.dist && best.wire != -1 &&
+                    (ref.wire > static_cast<uint32_t>(best.wire) ||
+                     (ref.wire == static_cast<uint32_t>(best.wire) && ref.seg > static_cast<uint32_t>(best.seg))))
+                    continue;
+                best.wire = static_cast<int>(ref.wire);
+                best.seg = static_cast<int>(ref.seg);
+                best.pos = closest;
+                best.dist = d;
+            }
+        }
+    if (best.wire == -1) return false;
+    if (hit) *hit = best;
+    return true;
+}
+
+wxRect SegmentIndex::GetBounds(size_t wireIdx) const
+{
+    if (wireIdx >= m_wirePts.size() || m_wirePts[wireIdx].empty()) return wxRect();
+    const auto& pts = m_wirePts[wireIdx];
+    int x0 = pts[0].x, y0 = pts[0].y, x1 = x0, y1 = y0;
+    for (const wxPoint& p : pts) {
+        x0 = std::min(x0, p.x);
+        y0 = std::min(y0, p.y);
+        x1 = std::max(x1, p.x);
+        y1 = std::max(y1, p.y);
+    }
+    return wxRect(wxPoint(x0, y0), wxPoint(x1, y1));
+}
+
+int SegmentIndex::CountCrossings(const wxPoint& a, const wxPoint& b, int ignoreWire) const
+{
+    const bool horizontal = a.y == b.y;
+    if (!horizontal && a.x != b.x) return 0;
+    const int lo = horizontal ? std::min(a.x, b.x) : std::min(a.y, b.y);
+    const int hi = horizontal ? std::max(a.x, b.x) : std::max(a.y, b.y);
+    const int fixed = horizontal ? a.y : a.x;
+
+    int count = 0;
+    ForEachCell(a, b, [&](uint64_t key) {
+        auto it = m_cells.find(key);
+        if (it == m_cells.end()) return;
+        for (const SegRef& ref : it->second) {
+            if (static_cast<int>(ref.wire) == ignoreWire) continue;
+            const wxPoint& p = m_wirePts[ref.wire][ref.seg];
+            const wxPoint& q = m_wirePts[ref.wire][ref.seg + 1];
+            // 只算与 a-b 垂直的线段，且交点严格在两条线段内部
+            const int at = horizontal ? p.x : p.y;                  // 对方的固定坐标
+            if (horizontal ? p.x != q.x : p.y != q.y) continue;
+            const int s0 = horizontal ? std::min(p.y, q.y) : std::min(p.x, q.x);
+            const int s1 = horizontal ? std::max(p.y, q.y) : std::max(p.x, q.x);
+            if (at <= lo || at >= hi || fixed <= s0 || fixed >= s1) continue;
+            // 线段登记在多个格子里，只在交点所在的格子计数一次
+            const wxPoint cross = horizontal ? wxPoint(at, fixed) : wxPoint(fixed, at);
+            if (Key(CellOf(cross.x), CellOf(cross.y)) == key) ++count;
+        }
+        });
+    return count;
+}
+
+SegmentIndex::Contact SegmentIndex::MeasureContact(const wxPoint& a, const wxPoint& b, int ignoreWire) const
+{
+    Contact contact;
+    const bool horizontal = a.y == b.y;
+    if (!horizontal && a.x != b.x) return contact;
+    const int lo = horizontal ? std::min(a.x, b.x) : std::min(a.y, b.y);
+    const int hi = horizontal ? std::max(a.x, b.x) : std::max(a.y, b.y);
+    const int fixed = horizontal ? a.y : a.x;
+    auto onSegment = [&](const wxPoint& p) {
+        const int along = horizontal ? p.x : p.y;
+        return (horizontal ? p.y : p.x) == fixed && along >= lo && along <= hi;
+        };
+
+    ForEachCell(a, b, [&](uint64_t key) {
+        auto it = m_cells.find(key);
+        if (it == m_cells.end()) return;
+        // 线段登记在多个格子里，控制点和重叠段都只在起点所在的格子计数一次
+        auto inCell = [&](const wxPoint& p) { return Key(CellOf(p.x), CellOf(p.y)) == key; };
+        for (const SegRef& ref : it->second) {
+            if (static_cast<int>(ref.wire) == ignoreWire) continue;
+            const auto& pts = m_wirePts[ref.wire];
+            const wxPoint& p = pts[ref.seg];
+            const wxPoint& q = pts[ref.seg + 1];
+            // 每条线段只看起点，最后一段再看终点，相邻线段共用的点不重复
+            if (onSegment(p) && inCell(p)) ++contact.vertices;
+            if (ref.seg + 2 == pts.size() && onSegment(q) && inCell(q)) ++contact.vertices;
+
+            if (horizontal ? (p.y != fixed || q.y != fixed) : (p.x != fixed || q.x != fixed)) continue;
+            const int s0 = horizontal ? std::min(p.x, q.x) : std::min(p.y, q.y);
+            const int s1 = horizontal ? std::max(p.x, q.x) : std::max(p.y, q.y);
+            const int o0 = std::max(lo, s0), o1 = std::min(hi, s1);
+            if (o1 <= o0) continue;
+            if (inCell(horizontal ? wxPoint(o0, fixed) : wxPoint(fixed, o0))) contact.overlap += o1 - o0;
+        }
+        });
+    return contact;
+}
+
+void SegmentIndex::Query(const wxRect& area, std::vector<size_t>& out) const
+{
+    out.clear();
+    auto touches = [&](const wxPoint& a, const wxPoint& b) {
+        wxRect r(wxPoint(std::min(a.x, b.x), std::min(a.y, b.y)), wxPoint(std::max(a.x, b.x), std::max(a.y, b.y)));
+        return r.Intersects(area);
+        };
+
+    const int x0 = CellOf(area.GetLeft()), x1 = CellOf(area.GetRight());
+    const int y0 = CellOf(area.GetTop()), y1 = CellOf(area.GetBottom());
+    const int64_t cells = int64_t(x1 - x0 + 1) * (y1 - y0 + 1);
+    if (cells > static_cast<int64_t>(m_cells.size())) {
+        // 视口比登记的格子还多（缩得很小），逐条检查
+        for (size_t w = 0; w < m_wirePts.size(); ++w) {
+            const auto& pts = m_wirePts[w];
+            for (size_t s = 0; s + 1 < pts.size(); ++s)
+                if (touches(pts[s], pts[s + 1])) { out.push_back(w); break; }
+        }
+        return;
+    }
+    for (int cx = x0; cx <= x1; ++cx)
+        for (int cy = y0; cy <= y1; ++cy) {
+            auto it = m_cells.find(Key(cx, cy));
+            if (it == m_cells.end()) continue;
+            for (const SegRef& ref : it->second) {
+                const auto& pts = m_wirePts[ref.wire];
+                if (touches(pts[ref.seg], pts[ref.seg + 1])) out.push_back(ref.wire);
+            }
+        }
+    std::sort(out.begin(), out.end());
+    out.erase(std::unique(out.begin(), out.end()), out.end());
+}
+
+// ---------------- PinIndex ----------------
+
+void PinIndex::Clear()
+{
+    m_cells.clear();
+    m_elemPins.clear();
+}
+
+void PinIndex::Link(uint32_t idx)
+{
+    for (const Pin& pin : m_elemPins[idx])
+        m_cells[Key(CellOf(pin.pos.x), CellOf(pin.pos.y))].push_back(pin);
+}
+
+void PinIndex::Unlink(uint32_t idx)
+{
+    for (const Pin& pin : m_elemPins[idx]) {
+        auto it = m_cells.find(Key(CellOf(pin.pos.x), CellOf(pin.pos.y)));
+        if (it == m_cells.end()) continue;
+        auto& list = it->second;
+        for (size_t k = 0; k < list.size(); ++k) {
+            if (list[k].elem == idx && list[k].pin == pin.pin && list[k].isInput == pin.isInput) {
+                list[k] = list.back();
+                list.pop_back();
+                break;
+            }
+        }
+        if (list.empty()) m_cells.erase(it);
+    }
+}
+
+void PinIndex::Insert(size_t idx, const CanvasElement& elem)
+{
+    wxASSERT(idx == m_elemPins.size());
+    m_elemPins.emplace_back();
+    Update(idx, elem);
+}
+
+void PinIndex::Update(size_t idx, const CanvasElement& elem)
+{
+    if (idx >= m_elemPins.size()) return;
+    const uint32_t id = static_cast<uint32_t>(idx);
+    Unlink(id);
+    auto& pins = m_elemPins[idx];
+    pins.clear();
+    const auto& in = elem.GetInputPinWorld();
+    const auto& out = elem.GetOutputPinWorld();
+    for (size_t p = 0; p < in.size(); ++p)
+        pins.push_back({ id, static_cast<uint32_t>(p), true, in[p] });
+    for (size_t p = 0; p < out.size(); ++p)
+        pins.push_back({ id, static_cast<uint32_t>(p), false, out[p] });
+    Link(id);
+}
+
+void PinIndex::Remove(size_t idx)
+{
+    if (idx >= m_elemPins.size()) return;
+    Unlink(static_cast<uint32_t>(idx));
+
+    // 最后一个元件改用 idx 编号，只需改写它的引脚所在的格子
+    const size_t last = m_elemPins.size() - 1;
+    if (idx != last) {
+        for (const Pin& pin : m_elemPins[last])
+            for (Pin& p : m_cells[Key(CellOf(pin.pos.x), CellOf(pin.pos.y))])
+                if (p.elem == last) p.elem = static_cast<uint32_t>(idx);
+        m_elemPins[idx] = std::move(m_elemPins[last]);
+        for (Pin& p : m_elemPins[idx]) p.elem = static_cast<uint32_t>(idx);
+    }
+    m_elemPins.pop_back();
+}
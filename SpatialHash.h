@@ -0,0 +1,158 @@
+﻿#pragma once
+#include <wx/wx.h>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include "Wire.h"
+#include "CanvasElement.h"
+
+/*
+ * 均匀网格空间哈希：按 cellSize（默认与画布网格相同，20 px）划分格子，
+ * 每个对象登记在其包围盒覆盖的所有格子里
+ * 对象编号与画布容器下标一致，Remove 把最后一个对象移到空位（与 SlotMap 相同）
+ */
+class SpatialHash
+{
+public:
+    explicit SpatialHash(int cellSize = 20) : m_cellSize(cellSize) {}
+
+    void Clear();
+    void Insert(size_t idx, const wxRect& bounds);   // idx 必须等于 Size()（追加）
+    void Update(size_t idx, const wxRect& bounds);
+    void Remove(size_t idx);
+
+    // 包含 pt 的编号最小的对象，没有则返回 -1
+    int  HitTest(const wxPoint& pt) const;
+    // 包围盒与 area 相交的全部对象（升序、去重）
+    void Query(const wxRect& area, std::vector<size_t>& out) const;
+
+    size_t Size() const { return m_bounds.size(); }
+    const wxRect& GetBounds(size_t idx) const { return m_bounds[idx]; }
+
+private:
+    struct CellRange { int x0, y0, x1, y1; };
+
+    int       CellOf(int v) const;          // 向下取整，负坐标也正确
+    CellRange RangeOf(const wxRect& r) const;
+    static uint64_t Key(int cx, int cy)
+    {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(cx)) << 32) | static_cast<uint32_t>(cy);
+    }
+    void Link(uint32_t idx, const CellRange& range);
+    void Unlink(uint32_t idx, const CellRange& range);
+
+    int m_cellSize;
+    std::unordered_map<uint64_t, std::vector<uint32_t>> m_cells;
+    std::vector<wxRect>    m_bounds;
+    std::vector<CellRange> m_ranges;
+};
+
+/*
+ * 导线线段索引：同样按 cellSize 分格，每条线段只登记在它经过的格子里，
+ * 悬停查询只对光标附近格子里的线段计算精确的点到线段距离，
+ * 与导线长度无关
+ * 导线编号与 m_wires 下标一致，Remove 把最后一根导线移到空位
+ */
+class SegmentIndex
+{
+public:
+    explicit SegmentIndex(int cellSize = 20) : m_cellSize(cellSize) {}
+
+    struct Hit {
+        int     wire = -1;
+        int     seg = -1;       // 线段 pts[seg] -> pts[seg+1]
+        wxPoint pos;            // 线段上距离查询点最近的点
+        double  dist = 0;
+    };
+
+    void Clear();
+    void Insert(size_t wireIdx, const Wire& wire);   // wireIdx 必须等于 Size()（追加）
+    void Update(size_t wireIdx, const Wire& wire);
+    void Remove(size_t wireIdx);
+
+    // 距离 pt 不超过 tolerance 的最近线段；距离相同时取编号小的导线
+    bool HitTest(const wxPoint& pt, int tolerance, Hit* hit) const;
+    // 至少有一条线段与 area 相交的导线（升序、去重）
+    void Query(const wxRect& area, std::vector<size_t>& out) const;
+
+    size_t Size() const { return m_wirePts.size(); }
+    // 登记时的控制点包围盒：导线改动前调用，可得到旧位置
+    wxRect GetBounds(size_t wireIdx) const;
+    // 水平/竖直线段 a-b 与已登记导线的垂直交叉次数（不含端点处的接触），跳过 ignoreWire
+    int CountCrossings(const wxPoint& a, const wxPoint& b, int ignoreWire = -1) const;
+    // 水平/竖直线段 a-b 与已登记导线的接触，跳过 ignoreWire：
+    // overlap 为与共线线段重叠的总长度，vertices 为落在 a-b 上（含两端）的控制点个数
+    struct Contact { int overlap = 0; int vertices = 0; };
+    Contact MeasureContact(const wxPoint& a, const wxPoint& b, int ignoreWire = -1) const;
+
+private:
+    struct SegRef { uint32_t wire, seg; };
+
+    int CellOf(int v) const { return v >= 0 ? v / m_cellSize : -((-v + m_cellSize - 1) / m_cellSize); }
+    static uint64_t Key(int cx, int cy)
+    {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(cx)) << 32) | static_cast<uint32_t>(cy);
+    }
+    template <class Fn> void ForEachCell(const wxPoint& a, const wxPoint& b, Fn fn) const;
+    void Link(uint32_t wireIdx);
+    void Unlink(uint32_t wireIdx);
+
+    int m_cellSize;
+    std::unordered_map<uint64_t, std::vector<SegRef>> m_cells;
+    std::vector<std::vector<wxPoint>> m_wirePts;   // 每条导线的控制点坐标
+};
+
+/*
+ * 引脚索引：按 cellSize 分格登记每个引脚的世界坐标，
+ * 吸附（8 px）和悬停（4 px）只查光标附近的 2x2 个格子，与元件数量无关
+ * 元件编号与 m_elements 下标一致，Remove 把最后一个元件移到空位
+ */
+class PinIndex
+{
+public:
+    struct Pin {
+        uint32_t elem;
+        uint32_t pin;
+        bool     isInput;
+        wxPoint  pos;
+    };
+    // 与逐个元件扫描时的先后顺序一致：元件下标小的优先，同一元件先输入后输出
+    static bool Precedes(const Pin& a, const Pin& b)
+    {
+        if (a.elem != b.elem) return a.elem < b.elem;
+        if (a.isInput != b.isInput) return a.isInput;
+        return a.pin < b.pin;
+    }
+
+    explicit PinIndex(int cellSize = 20) : m_cellSize(cellSize) {}
+
+    void Clear();
+    void Insert(size_t idx, const CanvasElement& elem);   // idx 必须等于 Size()（追加）
+    void Update(size_t idx, const CanvasElement& elem);
+    void Remove(size_t idx);
+    size_t Size() const { return m_elemPins.size(); }
+
+    // 对距离 p 在 radius 以内（切比雪夫距离）的格子里的引脚调用 fn(const Pin&)，调用方再做精确判断
+    template <class Fn> void ForEachNear(const wxPoint& p, int radius, Fn fn) const
+    {
+        for (int cx = CellOf(p.x - radius); cx <= CellOf(p.x + radius); ++cx)
+            for (int cy = CellOf(p.y - radius); cy <= CellOf(p.y + radius); ++cy) {
+                auto it = m_cells.find(Key(cx, cy));
+                if (it == m_cells.end()) continue;
+                for (const Pin& pin : it->second) fn(pin);
+            }
+    }
+
+private:
+    int CellOf(int v) const { return v >= 0 ? v / m_cellSize : -((-v + m_cellSize - 1) / m_cellSize); }
+    static uint64_t Key(int cx, int cy)
+    {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(cx)) << 32) | static_cast<uint32_t>(cy);
+    }
+    void Link(uint32_t idx);
+    void Unlink(uint32_t idx);
+
+    int m_cellSize;
+    std::unordered_map<uint64_t, std::vector<Pin>> m_cells;
+    std::vector<std::vector<Pin>> m_elemPins;   // 每个元件登记时的引脚
+};
@@ -0,0 +1,85 @@
+﻿#include "SpriteCache.h"
+#include <wx/dcgraph.h>
+#include <wx/graphics.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+const int kPad = 3;   // 画布单位，给线宽和抗锯齿边缘留的余量
+
+int ZoomKey(double scale) { return static_cast<int>(std::lround(scale * 256)); }
+}
+
+void SpriteCache::Clear()
+{
+    m_sprites.clear();
+    m_uncacheable.clear();
+    m_zooms.clear();
+}
+
+void SpriteCache::TouchZoom(int zoom)
+{
+    if (std::find(m_zooms.begin(), m_zooms.end(), zoom) != m_zooms.end()) return;
+    m_zooms.push_back(zoom);
+    if (m_zooms.size() <= static_cast<size_t>(kMaxZoomLevels)) return;
+
+    // 丢弃最早的缩放级别
+    const int old = m_zooms.front();
+    m_zooms.pop_front();
+    auto drop = [old](auto& map) {
+        for (auto it = map.begin(); it != map.end();) {
+            if (static_cast<int>(it->first >> 24) == old) it = map.erase(it);
+            else ++it;
+        }
+        };
+    drop(m_sprites);
+    drop(m_uncacheable);
+}
+
+const SpriteCache::Sprite* SpriteCache::Get(const CanvasElement& elem, double scale, DetailLevel detail)
+{
+    const ComponentId id = elem.GetComponentId();
+    if (id == kInvalidComponent) return nullptr;
+
+    const int zoom = ZoomKey(scale);
+    const uint64_t key = Key(id, elem.GetFacing(), detail, zoom);
+    auto it = m_sprites.find(key);
+    if (it != m_sprites.end()) return &it->second;
+    if (m_uncacheable.count(key)) return nullptr;
+
+    TouchZoom(zoom);
+    Sprite sprite;
+    if (!Render(elem, zoom / 256.0, detail, sprite)) {
+        m_uncacheable[key] = true;
+        return nullptr;
+    }
+    return &m_sprites.emplace(key, std::move(sprite)).first->second;
+}
+
+bool SpriteCache::Render(const CanvasElement& elem, double scale, DetailLevel detail, Sprite& out) const
+{
+    // 放在原点的同朝向实例，包围盒即相对原点的范围
+    CanvasElement local(elem.GetPrototype(), wxPoint(0, 0), elem.GetFacing());
+    const wxRect b = local.GetBounds();
+    const int w = static_cast<int>(std::ceil((b.width + 2 * kPad) * scale));
+    const int h = static_cast<int>(std::ceil((b.height + 2 * kPad) * scale));
+    if (w <= 0 || h <= 0 || w > kMaxSpriteSize || h > kMaxSpriteSize) return false;
+
+    wxImage img(w, h);
+    img.InitAlpha();
+    std::memset(img.GetAlpha(), 0, static_cast<size_t>(w) * h);
+
+    out.origin = wxPoint(static_cast<int>(std::lround((kPad - b.x) * scale)),
+        static_cast<int>(std::lround((kPad - b.y) * scale)));
+    {
+        wxGraphicsContext* gc = wxGraphicsContext::Create(img);
+        if (!gc) return false;
+        wxGCDC dc(gc);   // 析构时把内容写回 img
+        dc.SetDeviceOrigin(out.origin.x, out.origin.y);
+        dc.SetUserScale(scale, scale);
+        local.Draw(dc, detail);
+    }
+    out.bitmap = wxBitmap(img, 32);
+    return out.bitmap.IsOk();
+}
@@ -0,0 +1,40 @@
+﻿#pragma once
+#include <wx/wx.h>
+#include <unordered_map>
+#include <deque>
+#include <cstdint>
+#include "CanvasElement.h"
+
+/*
+ * 元件位图缓存：每个（元件编号, 朝向, 缩放级别, 细节层次）预先用抗锯齿方式画成一张
+ * 带透明通道的位图，重绘时直接贴图，不再逐个图形调用 DC
+ * 缩放按 1/256 量化；最多保留 kMaxZoomLevels 个级别，超出时丢弃最早的级别
+ */
+class SpriteCache
+{
+public:
+    struct Sprite {
+        wxBitmap bitmap;
+        wxPoint  origin;   // 元件原点在位图中的像素位置
+    };
+
+    // 取得 elem 在 scale 下的位图；不适合缓存（无编号或太大）时返回 nullptr，调用方按矢量绘制
+    const Sprite* Get(const CanvasElement& elem, double scale, DetailLevel detail = DetailLevel::Full);
+    void Clear();
+
+    static constexpr int kMaxZoomLevels = 4;
+    static constexpr int kMaxSpriteSize = 1024;   // 单边像素上限，放得很大时直接矢量绘制
+
+private:
+    static uint64_t Key(ComponentId id, Facing facing, DetailLevel detail, int zoom)
+    {
+        return (static_cast<uint64_t>(zoom) << 24) | (static_cast<uint64_t>(detail) << 20) |
+            (static_cast<uint64_t>(facing) << 16) | id;
+    }
+    bool Render(const CanvasElement& elem, double scale, DetailLevel detail, Sprite& out) const;
+    void TouchZoom(int zoom);
+
+    std::unordered_map<uint64_t, Sprite> m_sprites;
+    std::unordered_map<uint64_t, bool>   m_uncacheable;   // 渲染过但太大的组合
+    std::deque<int> m_zooms;                              // 已缓存的缩放级别，最早的在前
+};
@@ -0,0 +1,263 @@
+﻿#include "SvgPath.h"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+
+namespace {
+
+const double kPi = 3.14159265358979323846;
+
+class Tokenizer
+{
+public:
+    explicit Tokenizer(const std::string& s) : m_s(s) {}
+
+    void SkipSeparators()
+    {
+        while (m_pos < m_s.size() && (std::isspace(static_cast<unsigned char>(m_s[m_pos])) || m_s[m_pos] == ','))
+            ++m_pos;
+    }
+    bool AtEnd() { SkipSeparators(); return m_pos >= m_s.size(); }
+    bool AtCommand()
+    {
+        SkipSeparators();
+        return m_pos < m_s.size() && std::isalpha(static_cast<unsigned char>(m_s[m_pos])) &&
+            m_s[m_pos] != 'e' && m_s[m_pos] != 'E';
+    }
+    char Command() { return m_s[m_pos++]; }
+
+    // 不用 strtod：界面设置了区域后小数点可能变成逗号
+    bool Number(double& v)
+    {
+        SkipSeparators();
+        size_t p = m_pos;
+        double sign = 1;
+        if (p < m_s.size() && (m_s[p] == '+' || m_s[p] == '-')) sign = m_s[p++] == '-' ? -1 : 1;
+        double mant = 0;
+        bool digits = false;
+        while (p < m_s.size() && std::isdigit(static_cast<unsigned char>(m_s[p]))) {
+            mant = mant * 10 + (m_s[p++] - '0');
+            digits = true;
+        }
+        if (p < m_s.size() && m_s[p] == '.') {
+            double scale = 0.1;
+            for (++p; p < m_s.size() && std::isdigit(static_cast<unsigned char>(m_s[p])); ++p, scale *= 0.1) {
+                mant += (m_s[p] - '0') * scale;
+                digits = true;
+            }
+        }
+        if (!digits) return false;
+        if (p < m_s.size() && (m_s[p] == 'e' || m_s[p] == 'E')) {
+            size_t q = p + 1;
+            int esign = 1, e = 0;
+            if (q < m_s.size() && (m_s[q] == '+' || m_s[q] == '-')) esign = m_s[q++] == '-' ? -1 : 1;
+            if (q < m_s.size() && std::isdigit(static_cast<unsigned char>(m_s[q]))) {
+                while (q < m_s.size() && std::isdigit(static_cast<unsigned char>(m_s[q])))
+                    e = std::min(e * 10 + (m_s[q++] - '0'), 400);
+                mant *= std::pow(10.0, esign * e);
+                p = q;
+            }
+        }
+        v = sign * mant;
+        m_pos = p;
+        return true;
+    }
+    // 弧线标志只有一位，允许与后面的数字连写（如 "a1 1 0 00 5 5"）
+    bool Flag(bool& f)
+    {
+        SkipSeparators();
+        if (m_pos >= m_s.size() || (m_s[m_pos] != '0' && m_s[m_pos] != '1')) return false;
+        f = m_s[m_pos++] == '1';
+        return true;
+    }
+
+private:
+    const std::string& m_s;
+    size_t m_pos = 0;
+};
+
+using Pt = SvgSubpath::Pt;
+
+void Quadratic(std::vector<Pt>& out, Pt p0, Pt p1, Pt p2, int segments)
+{
+    for (int i = 1; i <= segments; ++i) {
+        double t = double(i) / segments, u = 1 - t;
+        out.push_back({ u * u * p0.x + 2 * u * t * p1.x + t * t * p2.x,
+                        u * u * p0.y + 2 * u * t * p1.y + t * t * p2.y });
+    }
+}
+
+void Cubic(std::vector<Pt>& out, Pt p0, Pt p1, Pt p2, Pt p3, int segments)
+{
+    for (int i = 1; i <= segments; ++i) {
+        double t = double(i) / segments, u = 1 - t;
+        double a = u * u * u, b = 3 * u * u * t, c = 3 * u * t * t, d = t * t * t;
+        out.push_back({ a * p0.x + b * p1.x + c * p2.x + d * p3.x,
+                        a * p0.y + b * p1.y + c * p2.y + d * p3.y });
+    }
+}
+
+// 端点参数化的椭圆弧转换为中心参数化后细分（SVG 1.1 附录 F.6.5）
+void Arc(std::vector<Pt>& out, Pt p0, double rx, double ry, double phiDeg,
+    bool largeArc, bool sweep, Pt p1, int segments)
+{
+    if (p0.x == p1.x && p0.y == p1.y) return;
+    rx = std::fabs(rx);
+    ry = std::fabs(ry);
+    if (rx == 0 || ry == 0) {
+        out.push_back(p1);
+        return;
+    }
+    const double phi = phiDeg * kPi / 180.0, cs = std::cos(phi), sn = std::sin(phi);
+    const double dx = (p0.x - p1.x) / 2, dy = (p0.y - p1.y) / 2;
+    const double x1 = cs * dx + sn * dy, y1 = -sn * dx + cs * dy;
+
+    // 半径太小时按比例放大
+    double lambda = (x1 * x1) / (rx * rx) + (y1 * y1) / (ry * ry);
+    if (lambda > 1) {
+        rx *= std::sqrt(lambda);
+        ry *= std::sqrt(lambda);
+    }
+    double num = rx * rx * ry * ry - rx * rx * y1 * y1 - ry * ry * x1 * x1;
+    double den = rx * rx * y1 * y1 + ry * ry * x1 * x1;
+    double coef = den == 0 ? 0 : std::sqrt(std::max(0.0, num / den));
+    if (largeArc == sweep) coef = -coef;
+    const double cx1 = coef * rx * y1 / ry, cy1 = -coef * ry * x1 / rx;
+    const double cx = cs * cx1 - sn * cy1 + (p0.x + p1.x) / 2;
+    const double cy = sn * cx1 + cs * cy1 + (p0.y + p1.y) / 2;
+
+    const double theta = std::atan2((y1 - cy1) / ry, (x1 - cx1) / rx);
+    double delta = std::atan2((-y1 - cy1) / ry, (-x1 - cx1) / rx) - theta;
+    if (sweep && delta < 0) delta += 2 * kPi;
+    else if (!sweep && delta > 0) delta -= 2 * kPi;
+
+    // 按扫过的角度分段，整圆约 2*segments 段
+    int n = std::max(2, static_cast<int>(std::ceil(std::fabs(delta) / kPi * segments)));
+    for (int i = 1; i < n; ++i) {
+        double a = theta + delta * i / n;
+        double ex = rx * std::cos(a), ey = ry * std::sin(a);
+        out.push_back({ cs * ex - sn * ey + cx, sn * ex + cs * ey + cy });
+    }
+    out.push_back(p1);   // 终点精确落在 p1
+}
+
+} // namespace
+
+bool TessellateSvgPath(const std::string& d, std::vector<SvgSubpath>& out, int curveSegments)
+{
+    Tokenizer tk(d);
+    Pt cur{ 0, 0 }, start{ 0, 0 }, ctrl{ 0, 0 };
+    char cmd = 0, prev = 0;
+    SvgSubpath* sub = nullptr;
+
+    auto beginSubpath = [&](Pt p) {
+        out.emplace_back();
+        sub = &out.back();
+        sub->pts.push_back(p);
+        start = p;
+    };
+    auto ensureSubpath = [&] {
+        if (!sub || sub->closed) beginSubpath(cur);
+    };
+
+    while (!tk.AtEnd()) {
+        if (tk.AtCommand()) cmd = tk.Command();
+        else if (cmd == 0 || cmd == 'Z' || cmd == 'z') return false;   // 数字前没有命令
+
+        const bool rel = std::islower(static_cast<unsigned char>(cmd)) != 0;
+        const double ox = rel ? cur.x : 0, oy = rel ? cur.y : 0;
+        const char up = static_cast<char>(std::toupper(static_cast<unsigned char>(cmd)));
+        double v[7];
+        auto read = [&](int n) {
+            for (int i = 0; i < n; ++i)
+                if (!tk.Number(v[i])) return false;
+            return true;
+        };
+
+        switch (up) {
+        case 'M':
+            if (!read(2)) return false;
+            cur = { ox + v[0], oy + v[1] };
+            beginSubpath(cur);
+            cmd = rel ? 'l' : 'L';   // 后续坐标对按 LineTo 处理
+            break;
+        case 'L':
+            if (!read(2)) return false;
+            ensureSubpath();
+            cur = { ox + v[0], oy + v[1] };
+            sub->pts.push_back(cur);
+            break;
+        case 'H':
+            if (!read(1)) return false;
+            ensureSubpath();
+            cur.x = ox + v[0];
+            sub->pts.push_back(cur);
+            break;
+        case 'V':
+            if (!read(1)) return false;
+            ensureSubpath();
+            cur.y = oy + v[0];
+            sub->pts.push_back(cur);
+            break;
+        case 'C':
+        case 'S': {
+            Pt c1;
+            if (up == 'C') {
+                if (!read(6)) return false;
+                c1 = { ox + v[0], oy + v[1] };
+                v[0] = v[2]; v[1] = v[3]; v[2] = v[4]; v[3] = v[5];
+            }
+            else {
+                if (!read(4)) return false;
+                const bool smooth = prev == 'C' || prev == 'S';
+                c1 = smooth ? Pt{ 2 * cur.x - ctrl.x, 2 * cur.y - ctrl.y } : cur;
+            }
+            ensureSubpath();
+            Pt c2{ ox + v[0], oy + v[1] }, end{ ox + v[2], oy + v[3] };
+            Cubic(sub->pts, cur, c1, c2, end, curveSegments);
+            ctrl = c2;
+            cur = end;
+            break;
+        }
+        case 'Q':
+        case 'T': {
+            Pt c;
+            if (up == 'Q') {
+                if (!read(4)) return false;
+                c = { ox + v[0], oy + v[1] };
+                v[0] = v[2]; v[1] = v[3];
+            }
+            else {
+                if (!read(2)) return false;
+                const bool smooth = prev == 'Q' || prev == 'T';
+                c = smooth ? Pt{ 2 * cur.x - ctrl.x, 2 * cur.y - ctrl.y } : cur;
+            }
+            ensureSubpath();
+            Pt end{ ox + v[0], oy + v[1] };
+            Quadratic(sub->pts, cur, c, end, curveSegments);
+            ctrl = c;
+            cur = end;
+            break;
+        }
+        case 'A': {
+            bool large, sweep;
+            if (!tk.Number(v[0]) || !tk.Number(v[1]) || !tk.Number(v[2]) ||
+                !tk.Flag(large) || !tk.Flag(sweep) || !tk.Number(v[3]) || !tk.Number(v[4]))
+                return false;
+            ensureSubpath();
+            Pt end{ ox + v[3], oy + v[4] };
+            Arc(sub->pts, cur, v[0], v[1], v[2], large, sweep, end, curveSegments);
+            cur = end;
+            break;
+        }
+        case 'Z':
+            if (sub && !sub->closed) sub->closed = true;
+            cur = start;
+            break;
+        default:
+            return false;
+        }
+        prev = up;
+    }
+    return true;
+}
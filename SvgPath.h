@@ -0,0 +1,17 @@
+﻿#pragma once
+#include <string>
+#include <vector>
+
+// 细分后的一段子路径（坐标为 double，由调用方取整）
+struct SvgSubpath {
+    struct Pt { double x, y; };
+    std::vector<Pt> pts;
+    bool closed = false;
+};
+
+/*
+ * SVG path 数据（d 属性）解析：支持 M L H V C S Q T A Z 及其小写相对形式，
+ * 曲线和椭圆弧按 curveSegments 细分为折线
+ * 遇到无法识别的内容时停止解析，已解析的部分保留在 out 中，返回 false
+ */
+bool TessellateSvgPath(const std::string& d, std::vector<SvgSubpath>& out, int curveSegments = 16);
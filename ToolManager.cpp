@@ -6,8 +6,8 @@ ToolManager::ToolManager(MainFrame* mainFrame, ToolBars* toolBars, CanvasPanel*
     : m_mainFrame(mainFrame), m_toolBars(toolBars), m_canvas(canvas),
     m_currentTool(ToolType::DEFAULT_TOOL), m_eventHandled(false),
     m_isDrawingWire(false), m_isPanning(false),
-    m_isEditingWire(false), m_editingWireIndex(-1), m_editingPointIndex(-1),
-    m_isDraggingElement(false), m_draggingElementIndex(-1) {
+    m_isEditingWire(false), m_editingPointIndex(-1),
+    m_isDraggingElement(false) {
 }
 
 void ToolManager::SetCurrentTool(ToolType tool) {
@@ -78,12 +78,15 @@ void ToolManager::SetCurrentTool(ToolType tool) {
 void ToolManager::OnCanvasLeftDown(const wxPoint& canvasPos) {
     m_eventHandled = false;
 
-    // 1. ȼǷ˵߿Ƶ
-    int cellWire, cellIdx;
-    wxPoint cellPos;
-    int newCell = m_canvas->HitHoverCell(canvasPos, &cellWire, &cellIdx, &cellPos);
-    if (newCell != -1) {
-        StartWireEditing(cellWire, cellIdx, canvasPos);
+    // 1. ȼǷ˵ߣ϶ϽǸƵ
+    int segWire, segIdx;
+    wxPoint segPos;
+    if (m_canvas->HitHoverSegment(canvasPos, &segWire, &segIdx, &segPos) != -1) {
+        const auto& pts = m_canvas->m_wires[segWire].pts;
+        const wxPoint d0 = segPos - pts[segIdx].pos;
+        const wxPoint d1 = segPos - pts[segIdx + 1].pos;
+        int pointIdx = (abs(d0.x) + abs(d0.y) <= abs(d1.x) + abs(d1.y)) ? segIdx : segIdx + 1;
+        StartWireEditing(segWire, pointIdx, canvasPos);
         m_eventHandled = true;
         return;
     }
@@ -106,8 +109,12 @@ void ToolManager::OnCanvasLeftDown(const wxPoint& canvasPos) {
             m_eventHandled = true;
             return;
         }
-        // ѡ񹤾µԪѡ񵫲϶
+        // ѡ񹤾µԪѡ񵫲϶ʱлֵ
         else if (m_currentTool == ToolType::SELECT_TOOL) {
+            if (m_mainFrame && m_mainFrame->DoSimToggleSource(elementIndex)) {
+                m_eventHandled = true;
+                return;
+            }
             m_canvas->SetSelectedIndex(elementIndex);
             m_eventHandled = true;
             return;
@@ -235,9 +242,10 @@ void ToolManager::UpdateWireDrawing(const wxPoint& currentPos) {
     wxPoint snappedPos = m_canvas->Snap(currentPos, &snapped);
 	ControlPoint endCP = { snappedPos, snapped ? CPType::Pin : CPType::Free };
 
-    // µԤ
-    m_canvas->m_tempWire.pts = Wire::RouteOrtho(m_startCP, endCP, PinDirection::Right, PinDirection::Left);
-    m_canvas->Refresh();
+    // µԤֻػԤ¾
+    m_canvas->RefreshCanvasRect(m_canvas->m_tempWire.GetBounds());
+    m_canvas->m_tempWire.pts = m_canvas->RouteWire(m_startCP, endCP);
+    m_canvas->RefreshCanvasRect(m_canvas->m_tempWire.GetBounds());
 
     if (m_mainFrame) {
         if (snapped) {
@@ -310,8 +318,9 @@ void ToolManager::OnCanvasKeyDown(wxKeyEvent& evt) {
         }
         else if (m_isDraggingElement) {
             // ȡԪ϶ָԭλ
-            if (m_draggingElementIndex != -1) {
-                m_canvas->m_elements[m_draggingElementIndex].SetPos(m_elementStartCanvasPos);
+            int elemIdx = m_canvas->m_elements.IndexOf(m_draggingElement);
+            if (elemIdx != -1) {
+                m_canvas->MoveElement(elemIdx, m_elementStartCanvasPos);
                 m_canvas->Refresh();
             }
             FinishElementDragging();
@@ -418,29 +427,27 @@ void ToolManager::FinishWireDrawing(const wxPoint& endPos) {
     completedWire.AddPoint(end);
 
     // ʹ·㷨·
-    completedWire.pts = Wire::RouteOrtho(m_startCP, end, PinDirection::Right, PinDirection::Left);
+    completedWire.pts = m_canvas->RouteWire(m_startCP, end);
 
     // ӵб
-    m_canvas->m_wires.emplace_back(completedWire);
+    WireHandle newHandle = m_canvas->AddWire(completedWire);
     Wire& newWire = m_canvas->m_wires.back();
-    newWire.GenerateCells();
 
     // ¼ӹϵӵţ
     auto recordConnection = [&](const wxPoint& pinPos, size_t ptIdx) {
         for (size_t i = 0; i < m_canvas->m_elements.size(); ++i) {
             const auto& elem = m_canvas->m_elements[i];
-            auto test = [&](const auto& pins, bool isIn) {
+            auto test = [&](const std::vector<wxPoint>& pins, bool isIn) {
                 for (size_t p = 0; p < pins.size(); ++p) {
-                    wxPoint w = elem.GetPos() + wxPoint(pins[p].pos.x, pins[p].pos.y);
-                    if (w == pinPos) {
-                        m_canvas->m_movingWires.push_back({ m_canvas->m_wires.size() - 1, ptIdx, isIn, p });
+                    if (pins[p] == pinPos) {
+                        m_canvas->m_movingWires.push_back({ newHandle, ptIdx, isIn, p });
                         return true;
                     }
                 }
                 return false;
                 };
-            if (test(elem.GetInputPins(), true)) return;
-            test(elem.GetOutputPins(), false);
+            if (test(elem.GetInputPinWorld(), true)) return;
+            test(elem.GetOutputPinWorld(), false);
         }
         };
 
@@ -452,6 +459,9 @@ void ToolManager::FinishWireDrawing(const wxPoint& endPos) {
     if (newWire.pts.back().type == CPType::Pin)
         recordConnection(newWire.pts.back().pos, newWire.pts.size() - 1);
 
+    // ¼֮ T 
+    m_canvas->DetectTJunctions(m_canvas->m_wires.size() - 1);
+
     // ״̬
     m_isDrawingWire = false;
     m_canvas->m_wireMode = CanvasPanel::WireMode::Idle;
@@ -485,9 +495,10 @@ void ToolManager::StartWireEditing(int wireIndex, int pointIndex, const wxPoint&
 
 	m_currentTool = ToolType::WIRE_TOOL;
     m_isEditingWire = true;
-    m_editingWireIndex = wireIndex;
+    m_editingWire = m_canvas->m_wires.HandleAt(wireIndex);
     m_editingPointIndex = pointIndex;
     m_editStartPos = startPos;
+    m_canvas->SetEditingWire(m_editingWire);
 
     if (m_mainFrame) {
         m_mainFrame->SetStatusText("༭: ϶Ƶ·");
@@ -496,8 +507,11 @@ void ToolManager::StartWireEditing(int wireIndex, int pointIndex, const wxPoint&
 
 void ToolManager::UpdateWireEditing(const wxPoint& currentPos) {
     if (!m_isEditingWire) return;
+    int wireIdx = m_canvas->m_wires.IndexOf(m_editingWire);
+    if (wireIdx < 0) return;
 
-    Wire& wire = m_canvas->m_wires[m_editingWireIndex];
+    Wire& wire = m_canvas->m_wires[wireIdx];
+    m_canvas->RefreshWire(wireIdx);   // λ
 
     // ¿Ƶλ
     if (m_editingPointIndex >= 0 && m_editingPointIndex < (int)wire.pts.size()) {
@@ -505,19 +519,23 @@ void ToolManager::UpdateWireEditing(const wxPoint& currentPos) {
 
         // ɵ·Ƕ˵㣩
         if (m_editingPointIndex == 0 || m_editingPointIndex == (int)wire.pts.size() - 1) {
-            wire.pts = Wire::RouteOrtho(wire.pts.front(), wire.pts.back(), PinDirection::Right, PinDirection::Left);
+            const bool isStart = m_editingPointIndex == 0;
+            wire.pts = m_canvas->RouteWire(wire.pts.front(), wire.pts.back(), wireIdx);
+            // ²ߺ䣬϶ͬһ˵
+            m_editingPointIndex = isStart ? 0 : (int)wire.pts.size() - 1;
         }
 
-        // ɿƵ
-        wire.GenerateCells();
+        // ͬ߶
+        m_canvas->UpdateWire(wireIdx);
     }
 
-    m_canvas->Refresh();
+    m_canvas->RefreshWire(wireIdx);   // λ
 }
 
 void ToolManager::FinishWireEditing() {
     m_isEditingWire = false;
-    m_editingWireIndex = -1;
+    m_editingWire = WireHandle();
+    m_canvas->SetEditingWire(WireHandle());
     m_editingPointIndex = -1;
 
     if (m_mainFrame) {
@@ -527,7 +545,8 @@ void ToolManager::FinishWireEditing() {
 
 void ToolManager::CancelWireEditing() {
     m_isEditingWire = false;
-    m_editingWireIndex = -1;
+    m_editingWire = WireHandle();
+    m_canvas->SetEditingWire(WireHandle());
     m_editingPointIndex = -1;
 
     if (m_mainFrame) {
@@ -548,27 +567,22 @@ void ToolManager::StartElementDragging(int elementIndex, const wxPoint& startPos
     if (elementIndex < 0 || elementIndex >= (int)m_canvas->m_elements.size()) return;
 
     m_isDraggingElement = true;
-    m_draggingElementIndex = elementIndex;
+    m_draggingElement = m_canvas->m_elements.HandleAt(elementIndex);
     m_elementDragStartPos = startPos;
     m_elementStartCanvasPos = m_canvas->m_elements[elementIndex].GetPos();
 
-    // ռԪŶӦĵ߶˵
+    // ռԪŶӦĵ߶˵㣨ֱӲѯɨȫߣ
     m_canvas->m_movingWires.clear();
+    m_canvas->m_movingElement = m_draggingElement;
     const auto& elem = m_canvas->m_elements[elementIndex];
+    const Netlist& netlist = m_canvas->GetNetlist();
+    std::vector<std::pair<size_t, size_t>> ends;
     auto collect = [&](const auto& pins, bool isIn) {
         for (size_t p = 0; p < pins.size(); ++p) {
-            wxPoint pinWorld = elem.GetPos() + wxPoint(pins[p].pos.x, pins[p].pos.y);
-            for (size_t w = 0; w < m_canvas->m_wires.size(); ++w) {
-                const auto& wire = m_canvas->m_wires[w];
-                if (!wire.pts.empty() && wire.pts.front().type == CPType::Pin &&
-                    wire.pts.front().pos == pinWorld)
-                    m_canvas->m_movingWires.push_back({ w, 0, isIn, p });
-
-                if (wire.pts.size() > 1 &&
-                    wire.pts.back().type == CPType::Pin &&
-                    wire.pts.back().pos == pinWorld)
-                    m_canvas->m_movingWires.push_back({ w, wire.pts.size() - 1, isIn, p });
-            }
+            ends.clear();
+            netlist.GetPinWires(elementIndex, isIn, p, ends);
+            for (const auto& e : ends)
+                m_canvas->m_movingWires.push_back({ m_canvas->m_wires.HandleAt(e.first), e.second, isIn, p });
         }
         };
     collect(elem.GetInputPins(), true);
@@ -580,7 +594,9 @@ void ToolManager::StartElementDragging(int elementIndex, const wxPoint& startPos
 }
 
 void ToolManager::UpdateElementDragging(const wxPoint& currentPos) {
-    if (!m_isDraggingElement || m_draggingElementIndex == -1) return;
+    if (!m_isDraggingElement) return;
+    int elemIdx = m_canvas->m_elements.IndexOf(m_draggingElement);
+    if (elemIdx == -1) return;
 
     // ƫ
     wxPoint delta = currentPos - m_elementDragStartPos;
@@ -590,23 +606,27 @@ void ToolManager::UpdateElementDragging(const wxPoint& currentPos) {
     wxString debugInfo = wxString::Format("϶Ԫ: (%d,%d)    [",
         newPos.x, newPos.y);
 
-    // Ԫλ
-    m_canvas->m_elements[m_draggingElementIndex].SetPos(newPos);
+    // Ԫλã¾ػ棩
+    m_canvas->RefreshElement(elemIdx);
+    m_canvas->MoveElement(elemIdx, newPos);
+    m_canvas->RefreshElement(elemIdx);
+
+    // ߣÿƶֻ L Ԥͣٻɿ
+    m_canvas->UpdateMovingWires(false);
+    m_canvas->ScheduleReroute();
 
-    // ص߶˵
+    // ״̬ʾ
     bool firstWire = true;
     for (const auto& aw : m_canvas->m_movingWires) {
-        if (aw.wireIdx >= m_canvas->m_wires.size()) continue;
-
-        Wire& wire = m_canvas->m_wires[aw.wireIdx];
+        int wireIdx = m_canvas->m_wires.IndexOf(aw.wire);
+        if (wireIdx < 0) continue;
 
         // 
-        const auto& elem = m_canvas->m_elements[m_draggingElementIndex];
-        const auto& pins = aw.isInput ? elem.GetInputPins() : elem.GetOutputPins();
+        const auto& elem = m_canvas->m_elements[elemIdx];
+        const auto& pins = aw.isInput ? elem.GetInputPinWorld() : elem.GetOutputPinWorld();
         if (aw.pinIdx >= pins.size()) continue;
 
-        wxPoint pinOffset = wxPoint(pins[aw.pinIdx].pos.x, pins[aw.pinIdx].pos.y);
-        wxPoint newPinPos = elem.GetPos() + pinOffset;
+        wxPoint newPinPos = pins[aw.pinIdx];
 
         // ϸϢϢ - ֿʽ
         if (!firstWire) {
@@ -616,22 +636,12 @@ void ToolManager::UpdateElementDragging(const wxPoint& currentPos) {
         // ַֿ⸴ӵĸʽ
         wxString wireType = aw.isInput ? wxString("") : wxString("");
         wxString wireInfo = wxString::Format("%d-%s%d(%d,%d)",
-            (int)aw.wireIdx,
+            wireIdx,
             wireType,
             (int)aw.pinIdx,
             newPinPos.x, newPinPos.y);
         debugInfo += wireInfo;
         firstWire = false;
-
-        // µ߶˵
-        if (aw.ptIdx == 0)
-            wire.pts.front().pos = newPinPos;
-        else
-            wire.pts.back().pos = newPinPos;
-
-        // ɵ·
-        wire.pts = Wire::RouteOrtho(wire.pts.front(), wire.pts.back(), PinDirection::Right, PinDirection::Left);
-        wire.GenerateCells();
     }
 
 	debugInfo += "]";
@@ -639,14 +649,12 @@ void ToolManager::UpdateElementDragging(const wxPoint& currentPos) {
     if (m_mainFrame) {
         m_mainFrame->SetStatusText(debugInfo);
     }
-
-    m_canvas->Refresh();
 }
 
 void ToolManager::FinishElementDragging() {
     m_isDraggingElement = false;
-    m_draggingElementIndex = -1;
-    m_canvas->m_movingWires.clear();
+    m_draggingElement = ElementHandle();
+    m_canvas->FinishMovingWires();   // һ
 
     if (m_mainFrame) {
         m_mainFrame->SetStatusText("Ԫ");
@@ -685,21 +693,29 @@ void ToolManager::HandleHoverFeedback(const wxPoint& canvasPos) {
     wxPoint hoverWorld;
     int newHover = m_canvas->HitHoverPin(canvasPos, &isInput, &hoverWorld);
     if (newHover != m_canvas->m_hoverPinIdx || isInput != m_canvas->m_hoverIsInput) {
+        // ֻػ¾ԲȦ
+        if (m_canvas->m_hoverPinIdx != -1)
+            m_canvas->RefreshCanvasRect(CanvasPanel::HoverMarkRect(m_canvas->m_hoverPinPos));
         m_canvas->m_hoverPinIdx = newHover;
         m_canvas->m_hoverIsInput = isInput;
         m_canvas->m_hoverPinPos = hoverWorld;
-        m_canvas->Refresh();
+        if (newHover != -1)
+            m_canvas->RefreshCanvasRect(CanvasPanel::HoverMarkRect(hoverWorld));
     }
 
-    // ߿Ƶͣ
-    int cellWire, cellIdx;
-    wxPoint cellPos;
-    int newCell = m_canvas->HitHoverCell(canvasPos, &cellWire, &cellIdx, &cellPos);
-    if (newCell != m_canvas->m_hoverCellIdx || cellWire != m_canvas->m_hoverCellWire) {
-        m_canvas->m_hoverCellWire = cellWire;
-        m_canvas->m_hoverCellIdx = cellIdx;
-        m_canvas->m_hoverCellPos = cellPos;
-        m_canvas->Refresh();
+    // ͣ⣨߶Σ
+    int segWire, segIdx;
+    wxPoint segPos;
+    int newSeg = m_canvas->HitHoverSegment(canvasPos, &segWire, &segIdx, &segPos);
+    if (newSeg != m_canvas->m_hoverSegIdx || segWire != m_canvas->m_hoverSegWire ||
+        (newSeg != -1 && segPos != m_canvas->m_hoverSegPos)) {
+        if (m_canvas->m_hoverSegIdx != -1)
+            m_canvas->RefreshCanvasRect(CanvasPanel::HoverMarkRect(m_canvas->m_hoverSegPos));
+        m_canvas->m_hoverSegWire = segWire;
+        m_canvas->m_hoverSegIdx = segIdx;
+        m_canvas->m_hoverSegPos = segPos;
+        if (newSeg != -1)
+            m_canvas->RefreshCanvasRect(CanvasPanel::HoverMarkRect(segPos));
     }
 
     // ״̬
@@ -709,7 +725,7 @@ void ToolManager::HandleHoverFeedback(const wxPoint& canvasPos) {
             status = wxString::Format("ͣ%s - ʼƵ",
                 isInput ? "" : "");
         }
-        else if (newCell != -1) {
+        else if (newSeg != -1) {
             status = "ͣڵ߿Ƶ - ϶";
         }
         else {
@@ -750,9 +766,8 @@ void ToolManager::UpdatePanning(const wxPoint& currentPos) {
     if (!m_isPanning) return;
 
     wxPoint delta = currentPos - m_panStartPos;
-    m_canvas->m_offset += delta;
+    m_canvas->PanBy(delta);
     m_panStartPos = currentPos;
-    m_canvas->Refresh();
 
     if (m_mainFrame) {
         m_mainFrame->SetStatusText(wxString::Format("ƽƻ: ƫ(%d, %d)", delta.x, delta.y));
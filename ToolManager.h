@@ -33,13 +33,13 @@ private:
 
     // ߱༭״̬
     bool m_isEditingWire;
-    int m_editingWireIndex;
+    WireHandle m_editingWire;
     int m_editingPointIndex;
     wxPoint m_editStartPos;
 
     // Ԫ϶״̬
     bool m_isDraggingElement;
-    int m_draggingElementIndex;
+    ElementHandle m_draggingElement;
     wxPoint m_elementDragStartPos;
     wxPoint m_elementStartCanvasPos;
 
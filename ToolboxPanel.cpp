@@ -1,5 +1,6 @@
 ﻿#include "ToolboxPanel.h"
 #include "ToolboxModel.h"
+#include "CanvasElement.h"
 #include <wx/artprov.h>
 #include <wx/dnd.h>
 #include <wx/treectrl.h>
@@ -176,6 +177,7 @@ ToolboxPanel::ToolboxPanel(wxWindow* parent)
 
     // 绑定“树节点选中事件”（Logisim是单击选中，不是双击）
     m_tree->Bind(wxEVT_TREE_SEL_CHANGED, &ToolboxPanel::OnToolSelected, this);
+    m_propGrid->Bind(wxEVT_PG_CHANGED, &ToolboxPanel::OnPropertyChanged, this);
 }
 
 void ToolboxPanel::LoadToolIcon(const wxString& toolName, const wxString& pngFileName)
@@ -549,6 +551,7 @@ void ToolboxPanel::OnToolSelected(wxTreeEvent& evt)
     }
     else {
         // 选中分类节点，清空属性面板
+        m_currentTool.clear();
         m_propGrid->Clear();
         m_propGrid->Append(new wxPropertyCategory("No Tool Selected"));
     }
@@ -557,6 +560,7 @@ void ToolboxPanel::OnToolSelected(wxTreeEvent& evt)
 void ToolboxPanel::UpdatePropertyPanel(const wxString& toolName)
 {
     // 1. 清空原有属性
+    m_currentTool = toolName;
     m_propGrid->Clear();
 
     // 2. 添加分类标题
@@ -591,4 +595,22 @@ void ToolboxPanel::UpdatePropertyPanel(const wxString& toolName)
         }
         // 忽略颜色类型，或者将其转换为字符串
     }
-}
\ No newline at end of file
+}
+void ToolboxPanel::OnPropertyChanged(wxPropertyGridEvent& evt)
+{
+    auto it = m_toolPropMap.find(m_currentTool);
+    if (it == m_toolPropMap.end()) return;
+    const wxString name = evt.GetPropertyName();
+    const wxVariant value = evt.GetPropertyValue();
+
+    // 更新默认值，重新选中工具时显示修改后的值
+    for (auto& prop : it->second)
+        if (prop.propName == name) prop.defaultValue = value;
+
+    // 写回同名的元件模板：放置时复制模板，属性随之带到新元件上（如仿真读取的 "Negate N"）
+    extern std::vector<CanvasElement> g_elements;
+    const wxString text = value.GetType() == "bool" ? wxString(value.GetBool() ? "true" : "false") : value.GetString();
+    for (auto& elem : g_elements)
+        if (elem.GetName() == m_currentTool) elem.SetProperty(name, text);
+    MY_LOG("属性修改：" + m_currentTool + " / " + name + " = " + text);
+}
@@ -41,6 +41,8 @@ private:
     void OnToolSelected(wxTreeEvent& evt); // 工具选中事件（核心）
     void InitToolPropertyMap();            // 初始化工具-属性映射表
     void UpdatePropertyPanel(const wxString& toolName); // 更新属性面板
+    void OnPropertyChanged(wxPropertyGridEvent& evt);   // 属性修改后写回元件模板，之后放置的元件沿用
+    wxString m_currentTool;                             // 属性面板当前显示的工具
 
     wxDECLARE_EVENT_TABLE();
 };
\ No newline at end of file
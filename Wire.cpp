@@ -1,10 +1,59 @@
 #include "Wire.h"
+#include <wx/graphics.h>
+#include <algorithm>
+#include <cmath>
 
-void Wire::Draw(wxDC& dc) const {
+void Wire::Draw(wxDC& dc, const wxColour& colour, bool thin) const {
     if (pts.size() < 2) return;
-    dc.SetPen(wxPen(*wxBLACK, 2));
-    for (size_t i = 1; i < pts.size(); ++i)
-        dc.DrawLine(pts[i - 1].pos, pts[i].pos);
+    std::vector<wxPoint> buf;
+    buf.reserve(pts.size());
+    for (const auto& cp : pts) buf.push_back(cp.pos);
+    dc.SetPen(wxPen(colour, thin ? 1 : 2));
+    dc.DrawLines(static_cast<int>(buf.size()), buf.data());   // һεû
+}
+
+void WireBatch::Add(const Wire& wire, const wxColour& colour) {
+    if (wire.pts.size() < 2) return;
+    size_t g = 0;
+    while (g < m_used && m_groups[g].colour != colour) ++g;
+    if (g == m_used) {
+        if (m_used == m_groups.size()) m_groups.emplace_back();
+        m_groups[g].colour = colour;
+        m_groups[g].pts.clear();
+        m_groups[g].counts.clear();
+        ++m_used;
+    }
+    Group& group = m_groups[g];
+    for (const auto& cp : wire.pts) group.pts.push_back(cp.pos);
+    group.counts.push_back(static_cast<int>(wire.pts.size()));
+}
+
+void WireBatch::Flush(wxDC& dc, int penWidth) {
+    wxGraphicsContext* gc = dc.GetGraphicsContext();
+    for (size_t g = 0; g < m_used; ++g) {
+        const Group& group = m_groups[g];
+        const wxPen pen(group.colour, penWidth);
+        if (gc) {
+            wxGraphicsPath path = gc->CreatePath();
+            const wxPoint* p = group.pts.data();
+            for (int n : group.counts) {
+                path.MoveToPoint(p[0].x, p[0].y);
+                for (int i = 1; i < n; ++i) path.AddLineToPoint(p[i].x, p[i].y);
+                p += n;
+            }
+            gc->SetPen(pen);
+            gc->StrokePath(path);
+        }
+        else {
+            dc.SetPen(pen);
+            const wxPoint* p = group.pts.data();
+            for (int n : group.counts) {
+                dc.DrawLines(n, p);
+                p += n;
+            }
+        }
+    }
+    m_used = 0;
 }
 std::vector<ControlPoint> Wire::RouteOrtho(
     const ControlPoint& start,
@@ -39,6 +88,16 @@ std::vector<ControlPoint> Wire::RouteOrtho(
 }
 
 
+std::vector<ControlPoint> Wire::RouteL(const ControlPoint& start, const ControlPoint& end)
+{
+    std::vector<ControlPoint> out;
+    out.push_back(start);
+    if (start.pos.x != end.pos.x && start.pos.y != end.pos.y)
+        out.push_back({ wxPoint(end.pos.x, start.pos.y), CPType::Bend });
+    out.push_back(end);
+    return out;
+}
+
 wxPoint Wire::CalculateHorizontalExit(const wxPoint& pinPos, PinDirection dir) {
     const int EXIT_DISTANCE = 20; // ˮƽ
 
@@ -87,25 +146,37 @@ void Wire::ConnectExits(std::vector<ControlPoint>& path,
 }
 
 
-void Wire::GenerateCells()
+wxRect Wire::GetBounds() const
 {
-    cells.clear();
-    if (pts.size() < 2) return;
+    if (pts.empty()) return wxRect();
+    int x0 = pts[0].pos.x, y0 = pts[0].pos.y, x1 = x0, y1 = y0;
+    for (const auto& cp : pts) {
+        x0 = std::min(x0, cp.pos.x);
+        y0 = std::min(y0, cp.pos.y);
+        x1 = std::max(x1, cp.pos.x);
+        y1 = std::max(y1, cp.pos.y);
+    }
+    return wxRect(wxPoint(x0, y0), wxPoint(x1, y1));
+}
 
-    for (size_t i = 1; i < pts.size(); ++i) {
-        wxPoint p0 = pts[i - 1].pos;
-        wxPoint p1 = pts[i].pos;
-        int dx = abs(p1.x - p0.x);
-        int dy = abs(p1.y - p0.y);
-        int steps = std::max(dx, dy) / 5;          // ÿ 2 px һ
-        if (steps == 0) steps = 1;
-        for (int s = 0; s <= steps; ++s) {
-            double t = double(s) / steps;
-            wxPoint cell((1 - t) * p0.x + t * p1.x,
-                (1 - t) * p0.y + t * p1.y);
-            // ȥأѡ
-            if (cells.empty() || cell != cells.back())
-                cells.push_back(cell);
-        }
+double Wire::DistanceToSegment(const wxPoint& p, const wxPoint& a, const wxPoint& b, wxPoint* closest)
+{
+    wxPoint c;
+    if (a.y == b.y) {          // ˮƽ
+        c = wxPoint(std::clamp(p.x, std::min(a.x, b.x), std::max(a.x, b.x)), a.y);
+    }
+    else if (a.x == b.x) {     // ֱ
+        c = wxPoint(a.x, std::clamp(p.y, std::min(a.y, b.y), std::max(a.y, b.y)));
     }
-}
\ No newline at end of file
+    else {                     // бߣֶ༭۵֣ܳ
+        const double dx = b.x - a.x, dy = b.y - a.y;
+        double t = ((p.x - a.x) * dx + (p.y - a.y) * dy) / (dx * dx + dy * dy);
+        t = std::clamp(t, 0.0, 1.0);
+        c = wxPoint(static_cast<int>(std::lround(a.x + t * dx)), static_cast<int>(std::lround(a.y + t * dy)));
+        if (closest) *closest = c;
+        const double ex = p.x - (a.x + t * dx), ey = p.y - (a.y + t * dy);
+        return std::sqrt(ex * ex + ey * ey);
+    }
+    if (closest) *closest = c;
+    return std::hypot(double(p.x - c.x), double(p.y - c.y));
+}
@@ -15,7 +15,7 @@ struct WireWireAnchor {
     size_t srcWire;   // µ
     size_t srcPt;     // 0  pts.size()-1
     size_t dstWire;   // ӵĵ
-    size_t dstCell;   // ӵС
+    size_t dstSeg;    // ӵ߶ţpts[dstSeg] -> pts[dstSeg+1]
 };
 
 enum class PinDirection {
@@ -33,22 +33,46 @@ public:
     explicit Wire(std::vector<ControlPoint> v) : pts(std::move(v)) {}
 
     // Ľӿ
-    void Draw(wxDC& dc) const;                          // 
+    void Draw(wxDC& dc, const wxColour& colour = *wxBLACK, bool thin = false) const;   // ߣʱźֵɫthin ΪСĵߣ WireBatch
     void AddPoint(const ControlPoint& cp) { pts.push_back(cp); }
     void Clear() { pts.clear(); }
     bool Empty() const { return pts.empty(); }
     size_t Size() const { return pts.size(); }
+    wxRect GetBounds() const;   // ƵΧУ߿յ߷ؿվ
 
     //·ɣManhattan Wiring洫ͳ·
     static std::vector<ControlPoint> RouteOrtho(const ControlPoint& start,
         const ControlPoint& end,
         PinDirection startDir,
         PinDirection endDir);
+    // ϶ʱԤֱ߻һ L 
+    static std::vector<ControlPoint> RouteL(const ControlPoint& start, const ControlPoint& end);
     static wxPoint CalculateHorizontalExit(const wxPoint& pinPos, PinDirection dir);
     static void ConnectExits(std::vector<ControlPoint>& path,
         const wxPoint& startExit, const wxPoint& endExit);
-    std::vector<wxPoint> cells;          // ÿ 2 px С
-    void GenerateCells();                // һз
+
+    // 㵽߶ a-b ľȷ룬closest ߶ĵ㣨ˮƽ/ֱ߶߿·
+    static double DistanceToSegment(const wxPoint& p, const wxPoint& a, const wxPoint& b, wxPoint* closest = nullptr);
 private:
 
+};
+
+/*
+ * ߣɫռߣÿɫֻһλ
+ * DC  wxGraphicsContext wxGCDCʱͬɫߺϳһ·һߣ
+ * ÿһ DrawLines
+ */
+class WireBatch {
+public:
+    void Add(const Wire& wire, const wxColour& colour);
+    void Flush(wxDC& dc, int penWidth);   // գһ֡
+
+private:
+    struct Group {
+        wxColour colour;
+        std::vector<wxPoint> pts;      // ߵĵβ
+        std::vector<int>     counts;   // ÿߵĵ
+    };
+    std::vector<Group> m_groups;       // ɫ٣ʱ 4 ֣Բ
+    size_t m_used = 0;                 // ֡õķ
 };
\ No newline at end of file
@@ -0,0 +1,83 @@
+﻿#pragma once
+#include <vector>
+#include <algorithm>
+#include <cstddef>
+#include "SlotMap.h"
+
+/* 导线-导线 T 型连接，用句柄保存，删除其他导线后依然有效 */
+struct WireJunction {
+    WireHandle srcWire;
+    size_t     srcPt;     // 0 或 pts.size()-1
+    WireHandle dstWire;
+    size_t     dstSeg;
+};
+
+/*
+ * T 型连接表：按导线句柄的槽位分别存放
+ * - out：该导线端点接到别的导线上的连接
+ * - in ：端点接在该导线上的导线（可重复，每个连接一项）
+ * 去掉一根导线的全部连接只涉及它自己和与它相连的导线，与连接总数无关
+ */
+class WireJunctionTable
+{
+public:
+    void clear()
+    {
+        m_slots.clear();
+        m_count = 0;
+    }
+    size_t size() const { return m_count; }
+
+    void Add(const WireJunction& j)
+    {
+        Slot(j.srcWire).out.push_back(j);
+        Slot(j.dstWire).in.push_back(j.srcWire);
+        ++m_count;
+    }
+
+    // 去掉 h 作为端点一侧或被接一侧的全部连接
+    void RemoveWire(WireHandle h)
+    {
+        if (h.slot >= m_slots.size()) return;
+        PerWire& self = m_slots[h.slot];
+        for (const WireJunction& j : self.out) {
+            if (j.dstWire.slot >= m_slots.size()) continue;
+            auto& in = m_slots[j.dstWire.slot].in;
+            auto it = std::find(in.begin(), in.end(), h);
+            if (it != in.end()) in.erase(it);
+        }
+        m_count -= self.out.size();
+        self.out.clear();
+
+        std::vector<WireHandle> sources;
+        sources.swap(self.in);
+        for (const WireHandle& src : sources) {
+            if (src.slot >= m_slots.size()) continue;
+            auto& out = m_slots[src.slot].out;
+            const size_t before = out.size();
+            out.erase(std::remove_if(out.begin(), out.end(),
+                [h](const WireJunction& j) { return j.dstWire == h; }), out.end());
+            m_count -= before - out.size();
+        }
+    }
+
+    template <class Fn> void ForEach(Fn fn) const
+    {
+        for (const PerWire& w : m_slots)
+            for (const WireJunction& j : w.out) fn(j);
+    }
+
+private:
+    struct PerWire {
+        std::vector<WireJunction> out;
+        std::vector<WireHandle>   in;
+    };
+    PerWire& Slot(WireHandle h)
+    {
+        if (h.slot >= m_slots.size()) m_slots.resize(h.slot + 1);
+        return m_slots[h.slot];
+    }
+
+    std::vector<PerWire> m_slots;   // 按句柄槽位
+    size_t m_count = 0;
+};
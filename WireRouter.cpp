@@ -0,0 +1,228 @@
+﻿#include "WireRouter.h"
+#include <algorithm>
+#include <cstdlib>
+
+namespace {
+
+// 行进方向：+x -x +y -y
+enum Heading : uint32_t { kRight, kLeft, kDown, kUp };
+const int kDx[4] = { 1, -1, 0, 0 };
+const int kDy[4] = { 0, 0, 1, -1 };
+
+Heading HeadingOf(PinDirection d)
+{
+    switch (d) {
+    case PinDirection::Right: return kRight;
+    case PinDirection::Left:  return kLeft;
+    case PinDirection::Down:  return kDown;
+    case PinDirection::Up:    return kUp;
+    }
+    return kRight;
+}
+Heading Opposite(uint32_t h) { return static_cast<Heading>(h ^ 1); }
+
+}
+
+int WireRouter::IndexOf(const std::vector<int>& axis, int v) const
+{
+    return static_cast<int>(std::lower_bound(axis.begin(), axis.end(), v) - axis.begin());
+}
+
+bool WireRouter::BuildGrid(const wxPoint& s, const wxPoint& g, const wxRect& window, const SpatialHash& elements, int clearance)
+{
+    elements.Query(window, m_found);
+    if (m_found.size() > m_opt.maxObstacles) return false;
+
+    m_obstacles.clear();
+    m_xs.assign({ window.GetLeft(), window.GetRight(), s.x, g.x });
+    m_ys.assign({ window.GetTop(), window.GetBottom(), s.y, g.y });
+    for (size_t idx : m_found) {
+        const wxRect bounds = elements.GetBounds(idx);
+        wxRect r = bounds;
+        r.Inflate(clearance);
+        // 加宽的间距把出线点包进去（出线点所在的元件）时退回基本间距
+        if (r.Contains(s) || r.Contains(g)) {
+            r = bounds;
+            r.Inflate(m_opt.clearance);
+        }
+        // 出线点落在障碍里（如从输入引脚往右引出）时忽略该障碍，否则无路可走
+        if (r.Contains(s) || r.Contains(g)) continue;
+        Box b{ r.GetLeft(), r.GetTop(), r.GetRight(), r.GetBottom() };
+        m_obstacles.push_back(b);
+        // 伸出窗口的边不加网格线，封边时仍按完整的障碍判断
+        if (b.x0 > window.GetLeft()) m_xs.push_back(b.x0);
+        if (b.x1 < window.GetRight()) m_xs.push_back(b.x1);
+        if (b.y0 > window.GetTop()) m_ys.push_back(b.y0);
+        if (b.y1 < window.GetBottom()) m_ys.push_back(b.y1);
+    }
+    std::sort(m_xs.begin(), m_xs.end());
+    m_xs.erase(std::unique(m_xs.begin(), m_xs.end()), m_xs.end());
+    std::sort(m_ys.begin(), m_ys.end());
+    m_ys.erase(std::unique(m_ys.begin(), m_ys.end()), m_ys.end());
+
+    // 网格线包含了障碍的边，所以每条网格边要么整段在障碍内部，要么不在
+    const size_t nx = m_xs.size(), ny = m_ys.size();
+    m_hBlocked.assign(ny * (nx - 1), 0);
+    m_vBlocked.assign((ny - 1) * nx, 0);
+    auto lower = [](const std::vector<int>& axis, int v) {   // 第一条 >= v 的线
+        return static_cast<int>(std::lower_bound(axis.begin(), axis.end(), v) - axis.begin());
+        };
+    auto upper = [](const std::vector<int>& axis, int v) {   // 第一条 > v 的线
+        return static_cast<int>(std::upper_bound(axis.begin(), axis.end(), v) - axis.begin());
+        };
+    for (const Box& b : m_obstacles) {
+        // 落在 [x0,x1] 内的竖线、严格在 (x0,x1) 内的竖线，横线同理
+        const int ia = lower(m_xs, b.x0), ib = upper(m_xs, b.x1);       // [ia, ib)
+        const int ic = upper(m_xs, b.x0), id = lower(m_xs, b.x1);       // [ic, id)
+        const int ja = lower(m_ys, b.y0), jb = upper(m_ys, b.y1);
+        const int jc = upper(m_ys, b.y0), jd = lower(m_ys, b.y1);
+        // 沿障碍边走是允许的，只封住严格在内部的边
+        for (int j = jc; j < jd; ++j)
+            for (int i = ia; i + 1 < ib; ++i)
+                m_hBlocked[j * (nx - 1) + i] = 1;
+        for (int j = ja; j + 1 < jb; ++j)
+            for (int i = ic; i < id; ++i)
+                m_vBlocked[j * nx + i] = 1;
+    }
+    return true;
+}
+
+bool WireRouter::Route(const ControlPoint& start, const ControlPoint& end,
+    PinDirection startDir, PinDirection endDir,
+    const SpatialHash& elements, const SegmentIndex* wires, int ignoreWire,
+    std::vector<ControlPoint>& out)
+{
+    out.clear();
+    if (start.pos == end.pos) {
+        out = Wire::RouteOrtho(start, end, startDir, endDir);
+        return true;
+    }
+
+    const wxPoint s = Wire::CalculateHorizontalExit(start.pos, startDir);
+    const wxPoint g = Wire::CalculateHorizontalExit(end.pos, endDir);
+    const uint32_t startHeading = HeadingOf(startDir);            // 到达起点出线点时的方向
+    const uint32_t goalHeading = Opposite(HeadingOf(endDir));     // 从终点出线点走向引脚的方向
+
+    wxRect window = wxRect(s, g).Union(wxRect(start.pos, end.pos));
+    window.Inflate(m_opt.margin);
+    // 新导线的编号就是 wires->Size()
+    const int wireId = ignoreWire >= 0 ? ignoreWire : (wires ? static_cast<int>(wires->Size()) : 0);
+    const int lane = m_opt.lanes > 1 ? wireId % m_opt.lanes : 0;
+    if (!BuildGrid(s, g, window, elements, m_opt.clearance + lane * m_opt.laneSpacing)) {
+        out = Wire::RouteOrtho(start, end, startDir, endDir);
+        return false;
+    }
+
+    const int nx = static_cast<int>(m_xs.size()), ny = static_cast<int>(m_ys.size());
+    const size_t states = static_cast<size_t>(nx) * ny * 4;
+    if (m_cost.size() < states) {
+        m_cost.resize(states);
+        m_from.resize(states);
+        m_seen.resize(states, 0);
+        m_done.resize(states, 0);
+    }
+    if (++m_stamp == 0) {   // 代数号回绕：清零重来
+        std::fill(m_seen.begin(), m_seen.end(), 0);
+        std::fill(m_done.begin(), m_done.end(), 0);
+        m_stamp = 1;
+    }
+
+    const int si = IndexOf(m_xs, s.x), sj = IndexOf(m_ys, s.y);
+    const int gi = IndexOf(m_xs, g.x), gj = IndexOf(m_ys, g.y);
+    const uint32_t goalNode = static_cast<uint32_t>(gj * nx + gi);
+    auto heuristic = [&](int i, int j) {
+        return static_cast<int64_t>(std::abs(m_xs[i] - g.x) + std::abs(m_ys[j] - g.y));
+    };
+
+    m_heap.clear();
+    const uint32_t first = static_cast<uint32_t>((sj * nx + si) * 4 + startHeading);
+    m_cost[first] = 0;
+    m_from[first] = first;
+    m_seen[first] = m_stamp;
+    m_heap.push_back({ heuristic(si, sj), first });
+
+    int64_t best = INT64_MAX;
+    uint32_t bestState = 0;
+    size_t expansions = 0;
+    while (!m_heap.empty()) {
+        std::pop_heap(m_heap.begin(), m_heap.end());
+        const HeapItem item = m_heap.back();
+        m_heap.pop_back();
+        if (item.f >= best) break;                    // 剩下的都不会更好
+        const uint32_t st = item.state;
+        if (m_done[st] == m_stamp) continue;
+        m_done[st] = m_stamp;
+        if (++expansions > m_opt.maxExpansions) break;
+
+        const uint32_t node = st / 4, heading = st % 4;
+        const int64_t cost = m_cost[st];
+        if (node == goalNode) {
+            // 最后一段走向引脚，方向不同要多一个拐弯
+            const int64_t total = cost + (heading != goalHeading ? m_opt.bendPenalty : 0);
+            if (total < best) {
+                best = total;
+                bestState = st;
+            }
+            continue;
+        }
+
+        const int i = node % nx, j = node / nx;
+        for (uint32_t nd = 0; nd < 4; ++nd) {
+            if (nd == Opposite(heading)) continue;    // 不走回头路
+            const int ni = i + kDx[nd], nj = j + kDy[nd];
+            if (ni < 0 || nj < 0 || ni >= nx || nj >= ny) continue;
+            const bool blocked = kDy[nd] == 0
+                ? m_hBlocked[j * (nx - 1) + std::min(i, ni)] != 0
+                : m_vBlocked[std::min(j, nj) * nx + i] != 0;
+            if (blocked) continue;
+
+            const wxPoint a(m_xs[i], m_ys[j]), b(m_xs[ni], m_ys[nj]);
+            int64_t step = std::abs(b.x - a.x) + std::abs(b.y - a.y);
+            if (nd != heading) step += m_opt.bendPenalty;
+            if (wires && m_opt.crossPenalty > 0)
+                step += static_cast<int64_t>(m_opt.crossPenalty) * wires->CountCrossings(a, b, ignoreWire);
+            if (wires && (m_opt.overlapPenalty > 0 || m_opt.vertexPenalty > 0)) {
+                const SegmentIndex::Contact c = wires->MeasureContact(a, b, ignoreWire);
+                step += static_cast<int64_t>(m_opt.overlapPenalty) * c.overlap
+                    + static_cast<int64_t>(m_opt.vertexPenalty) * c.vertices;
+            }
+
+            const uint32_t next = static_cast<uint32_t>((nj * nx + ni) * 4 + nd);
+            const int64_t nc = cost + step;
+            if (m_seen[next] == m_stamp && m_cost[next] <= nc) continue;
+            m_seen[next] = m_stamp;
+            m_cost[next] = nc;
+            m_from[next] = st;
+            m_heap.push_back({ nc + heuristic(ni, nj), next });
+            std::push_heap(m_heap.begin(), m_heap.end());
+        }
+    }
+
+    if (best == INT64_MAX) {
+        out = Wire::RouteOrtho(start, end, startDir, endDir);
+        return false;
+    }
+
+    // 回溯网格节点（倒序），再拼上两端引脚，合并共线的点
+    std::vector<wxPoint> pts;
+    pts.push_back(end.pos);
+    for (uint32_t st = bestState; ; st = m_from[st]) {
+        const uint32_t node = st / 4;
+        pts.push_back(wxPoint(m_xs[node % nx], m_ys[node / nx]));
+        if (m_from[st] == st) break;
+    }
+    pts.push_back(start.pos);
+    std::reverse(pts.begin(), pts.end());
+
+    out.push_back({ pts.front(), start.type });
+    for (size_t k = 1; k + 1 < pts.size(); ++k) {
+        const wxPoint& prev = out.back().pos;
+        const wxPoint& cur = pts[k];
+        const wxPoint& next = pts[k + 1];
+        if (cur == prev) continue;
+        const bool collinear = (prev.x == cur.x && cur.x == next.x) || (prev.y == cur.y && cur.y == next.y);
+        if (!collinear) out.push_back({ cur, CPType::Bend });
+    }
+    out.push_back({ pts.back(), end.type });
+    return true;
+}
@@ -0,0 +1,74 @@
+﻿#pragma once
+#include <wx/wx.h>
+#include <vector>
+#include <cstdint>
+#include "Wire.h"
+#include "SpatialHash.h"
+
+/*
+ * 避障正交布线：在稀疏网格上做 A*
+ * - 网格线取自搜索窗口内元件包围盒（外扩 clearance）的四条边和两个出线点，
+ *   矩形障碍之间的最优正交路径总能落在这些线上，不必按像素铺网格
+ * - 代价 = 长度 + 每个拐弯 bendPenalty + 每穿过一根已有导线 crossPenalty
+ *   + 与已有导线共线重叠的每像素 overlapPenalty + 每碰到已有导线的一个控制点 vertexPenalty，
+ *   避免不同导线叠在一起或共用折点
+ * - 每根导线按编号轮流取 lanes 档间距（clearance + k * laneSpacing），
+ *   绕同一个元件的几根导线落在不同的网格线上
+ * - 搜索限制在两端包围盒外扩 margin 的窗口内；障碍太多或扩展节点太多时放弃
+ * - 网格、代价和堆的存储在多次调用之间复用，访问标记用代数号，不必每次清零
+ * 找不到路径时退回 Wire::RouteOrtho 的固定走线
+ */
+class WireRouter
+{
+public:
+    struct Options {
+        int    clearance = 10;         // 导线与元件包围盒的间距
+        int    bendPenalty = 40;
+        int    crossPenalty = 60;
+        int    overlapPenalty = 8;     // 每像素
+        int    vertexPenalty = 200;
+        int    laneSpacing = 10;
+        int    lanes = 3;
+        int    margin = 120;           // 搜索窗口外扩
+        size_t maxObstacles = 256;
+        size_t maxExpansions = 100000;
+    };
+
+    WireRouter() = default;
+    explicit WireRouter(const Options& opt) : m_opt(opt) {}
+    Options& GetOptions() { return m_opt; }
+
+    // 起点/终点按 startDir/endDir 先引出一段（同 RouteOrtho），出线点之间由 A* 连接
+    // wires 为 nullptr 时不计交叉和重叠；ignoreWire 为正在重新布线的导线自身，为 -1 时按新导线处理
+    // 返回 false 表示没有找到路径，out 为固定走线
+    bool Route(const ControlPoint& start, const ControlPoint& end,
+        PinDirection startDir, PinDirection endDir,
+        const SpatialHash& elements, const SegmentIndex* wires, int ignoreWire,
+        std::vector<ControlPoint>& out);
+
+private:
+    struct Box { int x0, y0, x1, y1; };   // 闭区间
+    struct HeapItem {
+        int64_t  f;
+        uint32_t state;
+        bool operator<(const HeapItem& o) const { return f > o.f; }   // 小顶堆
+    };
+
+    bool BuildGrid(const wxPoint& s, const wxPoint& g, const wxRect& window, const SpatialHash& elements, int clearance);
+    int  IndexOf(const std::vector<int>& axis, int v) const;
+
+    Options m_opt;
+
+    // 复用的存储
+    std::vector<size_t>   m_found;
+    std::vector<Box>      m_obstacles;
+    std::vector<int>      m_xs, m_ys;        // 网格线坐标（升序去重）
+    std::vector<uint8_t>  m_hBlocked;        // (i,j)->(i+1,j) 穿过障碍
+    std::vector<uint8_t>  m_vBlocked;        // (i,j)->(i,j+1) 穿过障碍
+    std::vector<int64_t>  m_cost;            // 状态 = 节点 * 4 + 到达方向
+    std::vector<uint32_t> m_from;
+    std::vector<uint32_t> m_seen;            // == m_stamp 时 m_cost/m_from 有效
+    std::vector<uint32_t> m_done;            // == m_stamp 时已出堆
+    std::vector<HeapItem> m_heap;
+    uint32_t m_stamp = 0;
+};